@@ -0,0 +1,87 @@
+#include <cassert>
+
+#include "chunk.h"
+
+using namespace std;
+
+static long long floor_div(long long a, long long b) {
+    long long q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+static uint64_t chunk_key(long long cx, long long cy) {
+    return ((uint64_t) (uint32_t) cx << 32) | (uint32_t) cy;
+}
+
+world_t::world_t(uint64_t seed, const generator_t *generator, size_t max_bytes)
+        : seed(seed), generator(generator), max_bytes(max_bytes) {
+    assert(generator != NULL);
+    chunk_bytes = wallmap_t(CHUNK_SIZE, CHUNK_SIZE).bytes();
+}
+
+world_t::chunk_t &world_t::chunk(long long cx, long long cy) {
+    uint64_t key = chunk_key(cx, cy);
+    auto found = index.find(key);
+    if (found != index.end()) {
+        chunks.splice(chunks.begin(), chunks, found->second);
+        return chunks.front();
+    }
+
+    /* drop the least recently used chunks, but always keep the new one */
+    while (!chunks.empty() && (chunks.size() + 1) * chunk_bytes > max_bytes) {
+        index.erase(chunks.back().key);
+        chunks.pop_back();
+    }
+
+    chunks.push_front(chunk_t());
+    chunk_t &chunk = chunks.front();
+    chunk.key = key;
+    chunk.walls.resize(CHUNK_SIZE, CHUNK_SIZE);
+    index[key] = chunks.begin();
+
+    uint64_t chunk_seed = rng_t::splitmix64(seed ^ rng_t::splitmix64(key));
+    generator_run(generator, chunk.walls, chunk_seed);
+
+    /* one opening on each owned border, from a stream of its own so that
+     * it does not repeat the generator's first draws ("open") */
+    rng_t rand_num(rng_t::splitmix64(chunk_seed ^ 0x6f70656e));
+    wallmap_clear_bit(chunk.walls.right_row(rand_num.bounded(CHUNK_SIZE)), CHUNK_SIZE - 1);
+    wallmap_clear_bit(chunk.walls.up_row(CHUNK_SIZE - 1), rand_num.bounded(CHUNK_SIZE));
+    return chunk;
+}
+
+bool world_t::right_wall(long long x, long long y) {
+    long long cx = floor_div(x, CHUNK_SIZE), cy = floor_div(y, CHUNK_SIZE);
+    const wallmap_t &walls = chunk(cx, cy).walls;
+    return wallmap_bit(walls.right_row((int) (y - cy * CHUNK_SIZE)), (int) (x - cx * CHUNK_SIZE));
+}
+
+bool world_t::up_wall(long long x, long long y) {
+    long long cx = floor_div(x, CHUNK_SIZE), cy = floor_div(y, CHUNK_SIZE);
+    const wallmap_t &walls = chunk(cx, cy).walls;
+    return wallmap_bit(walls.up_row((int) (y - cy * CHUNK_SIZE)), (int) (x - cx * CHUNK_SIZE));
+}
+
+bool world_t::wall(long long x, long long y, int dir) {
+    switch (dir) {
+        case DIR_UP:
+            return up_wall(x, y);
+        case DIR_DOWN:
+            return up_wall(x, y - 1);
+        case DIR_LEFT:
+            return right_wall(x - 1, y);
+        default:
+            return right_wall(x, y);
+    }
+}
+
+bool world_t::operator()(long long ex, long long ey) {
+    bool odd_x = (ex & 1) != 0, odd_y = (ey & 1) != 0;
+    /* pillars and cell interiors */
+    if (odd_x == odd_y)
+        return !odd_x;
+    /* wall between two cells */
+    if (odd_x)
+        return up_wall(floor_div(ex - 1, 2), floor_div(ey, 2) - 1);
+    return right_wall(floor_div(ex, 2) - 1, floor_div(ey - 1, 2));
+}
@@ -0,0 +1,58 @@
+#ifndef CHUNK_H
+#define CHUNK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+
+#include "wallmap.h"
+#include "generator.h"
+
+#define CHUNK_SIZE 64
+
+/* lazily generated, unbounded maze
+ *
+ * the world is cut into CHUNK_SIZE x CHUNK_SIZE chunks of cells. a chunk is
+ * a perfect maze generated on first use from a seed derived from the world
+ * seed and its coordinates, so it comes back the same after being dropped.
+ * each chunk owns the walls on its right and upper borders and opens one of
+ * each at a position derived the same way, which keeps the world connected
+ * across chunk borders whatever order chunks are generated in.
+ *
+ * chunks are kept in least recently used order and the oldest are dropped
+ * once they take more than max_bytes.
+ */
+class world_t {
+public:
+    world_t(uint64_t seed, const generator_t *generator, size_t max_bytes);
+
+    /* cell view, dir is one of DIR_* */
+    bool wall(long long x, long long y, int dir);
+
+    /* expanded view: cell (x, y) is at (2x+1, 2y+1), "1" for walls as in mazemap */
+    bool operator()(long long ex, long long ey);
+
+    size_t chunk_count() const { return chunks.size(); }
+    size_t bytes() const { return chunks.size() * chunk_bytes; }
+
+    uint64_t seed;
+    const generator_t *generator;
+    size_t max_bytes;
+
+private:
+    typedef struct {
+        uint64_t key;
+        wallmap_t walls;
+    } chunk_t;
+
+    bool right_wall(long long x, long long y);
+    bool up_wall(long long x, long long y);
+    chunk_t &chunk(long long cx, long long cy);
+
+    std::list<chunk_t> chunks;                                          //most recently used first
+    std::unordered_map<uint64_t, std::list<chunk_t>::iterator> index;
+    size_t chunk_bytes;
+};
+
+#endif
@@ -0,0 +1,143 @@
+#include <cassert>
+#include <cstdio>
+#include <cstring>
+
+#include <vector>
+
+#include "eller.h"
+#include "generator_impl.h"
+#include "wallmap.h"
+#include "rng.h"
+
+using namespace std;
+
+void eller_generate(int width, int height, uint64_t seed, row_sink_t sink, void *userdata) {
+    assert(width > 0 && height > 0);
+    rng_t rand_num(seed);
+
+    int words_per_row = (width + 63) / 64;
+    vector<uint64_t> right(words_per_row), up(words_per_row);
+    vector<int> set(width, -1);             //set label of each cell in the row, -1 for none yet
+    vector<int> parent(width);              //union-find over labels while joining the row
+    vector<char> used(width);               //label taken by some cell of the row
+    vector<int> members(width);             //cells of each set seen so far
+    vector<int> chosen(width);              //cell picked to go up if the set does not on its own
+    vector<char> opened(width);             //set already goes up
+
+    maze_row_t row;
+    row.width = width;
+    row.words_per_row = words_per_row;
+    row.right = right.data();
+    row.up = up.data();
+
+    for (int y = 0; y < height; ++y) {
+        bool last = y == height - 1;
+
+        /* cells not joined from below start a set of their own */
+        memset(used.data(), 0, width);
+        for (int x = 0; x < width; ++x)
+            if (set[x] >= 0)
+                used[set[x]] = 1;
+        for (int x = 0, label = 0; x < width; ++x) {
+            if (set[x] < 0) {
+                while (used[label])
+                    ++label;
+                set[x] = label;
+                used[label] = 1;
+            }
+        }
+        for (int l = 0; l < width; ++l)
+            parent[l] = l;
+
+        /* join neighbours of different sets at random, all of them on the last row */
+        memset(right.data(), 0xff, words_per_row * sizeof(uint64_t));
+        memset(up.data(), 0xff, words_per_row * sizeof(uint64_t));
+        for (int x = 0; x + 1 < width; ++x) {
+            int a = find_set(parent, set[x]);
+            int b = find_set(parent, set[x + 1]);
+            if (a != b && (last || rand_num.coin())) {
+                parent[b] = a;
+                wallmap_clear_bit(right.data(), x);
+            }
+        }
+        for (int x = 0; x < width; ++x)
+            set[x] = find_set(parent, set[x]);
+
+        if (!last) {
+            /* every set goes up at least once, or it would be cut off */
+            for (int x = 0; x < width; ++x) {
+                members[set[x]] = 0;
+                opened[set[x]] = 0;
+            }
+            for (int x = 0; x < width; ++x) {
+                int l = set[x];
+                ++members[l];
+                if (rand_num.coin()) {
+                    wallmap_clear_bit(up.data(), x);
+                    opened[l] = 1;
+                } else if (rand_num.bounded(members[l]) == 0) {
+                    chosen[l] = x;
+                }
+            }
+            for (int x = 0; x < width; ++x) {
+                int l = set[x];
+                if (!opened[l]) {
+                    wallmap_clear_bit(up.data(), chosen[l]);
+                    opened[l] = 1;
+                }
+            }
+        }
+
+        row.y = y;
+        sink(&row, userdata);
+
+        /* only cells reached from below keep their set in the next row */
+        for (int x = 0; x < width; ++x)
+            if (wallmap_bit(up.data(), x))
+                set[x] = -1;
+    }
+}
+
+/* text file sink */
+
+typedef struct {
+    FILE *file;
+    vector<char> line;
+} text_sink_t;
+
+static void write_text_row(const maze_row_t *row, void *userdata) {
+    text_sink_t *sink = (text_sink_t *) userdata;
+    char *line = sink->line.data();
+    int rmw = row->width * 2 + 1;
+
+    /* the row of cells */
+    line[0] = '#';
+    for (int x = 0; x < row->width; ++x) {
+        line[x * 2 + 1] = ' ';
+        line[x * 2 + 2] = wallmap_bit(row->right, x) || x == row->width - 1 ? '#' : ' ';
+    }
+    fwrite(line, 1, rmw + 1, sink->file);
+
+    /* the walls above it */
+    for (int x = 0; x < row->width; ++x)
+        line[x * 2 + 1] = wallmap_bit(row->up, x) ? '#' : ' ';
+    for (int x = 0; x <= row->width; ++x)
+        line[x * 2] = '#';
+    fwrite(line, 1, rmw + 1, sink->file);
+}
+
+int eller_write_file(const char *filename, int width, int height, uint64_t seed) {
+    text_sink_t sink;
+    int rmw = width * 2 + 1;
+
+    sink.file = fopen(filename, "wb");
+    if (sink.file == NULL)
+        return 0;
+    sink.line.assign(rmw + 1, '#');
+    sink.line[rmw] = '\n';
+
+    /* bottom border */
+    fwrite(sink.line.data(), 1, rmw + 1, sink.file);
+    eller_generate(width, height, seed, write_text_row, &sink);
+    return fclose(sink.file) == 0;
+}
@@ -0,0 +1,28 @@
+#ifndef ELLER_H
+#define ELLER_H
+
+#include <cstdint>
+
+/* one row of a streamed maze
+ *
+ * right and up hold words_per_row words each, laid out like a row of
+ * wallmap_t: bit x is the wall to the right of / above cell x.
+ */
+typedef struct {
+    int y;
+    int width;
+    int words_per_row;
+    const uint64_t *right;
+    const uint64_t *up;
+} maze_row_t;
+
+typedef void (*row_sink_t)(const maze_row_t *row, void *userdata);
+
+/* Eller's algorithm: emits the rows from y = 0 upward, keeping O(width) state */
+void eller_generate(int width, int height, uint64_t seed, row_sink_t sink, void *userdata);
+
+/* streams the maze as text, '#' for walls and ' ' for ground, in the expanded
+ * (2w+1)x(2h+1) layout with the bottom row first; returns 0 on failure */
+int eller_write_file(const char *filename, int width, int height, uint64_t seed);
+
+#endif
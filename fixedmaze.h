@@ -0,0 +1,184 @@
+#ifndef FIXEDMAZE_H
+#define FIXEDMAZE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <array>
+#include <vector>
+
+#include "wallmap.h"
+#include "generator.h"
+#include "generator_impl.h"
+#include "maze.h"
+
+/* compile-time sized mazes for the difficulty presets
+ *
+ * fixed_wallmap_t<W, H> keeps the layout of wallmap_t in a std::array and
+ * fixed_maze_t<W, H> answers like maze_t, but the sizes and strides are
+ * constants, so generation, solving and drawing fold their index math and
+ * unroll their neighbour loops. the game picks the instance for its preset
+ * once at startup, see in_game_loop() in gamelogic.cpp.
+ */
+template <int W, int H>
+class fixed_wallmap_t {
+public:
+    static constexpr int width = W;
+    static constexpr int height = H;
+    static constexpr int words_per_row = (W + 63) / 64;
+    static constexpr int rmw = W * 2 + 1;
+    static constexpr int rmh = H * 2 + 1;
+
+    void fill(bool wall) {
+        memset(words.data(), wall ? 0xff : 0, sizeof(words));
+    }
+
+    /* expanded (2w+1)x(2h+1) view */
+    bool operator[](int idx) const {
+        int x = idx % rmw;
+        int y = idx / rmw;
+        /* outer border */
+        if (x == 0 || y == 0 || x == rmw - 1 || y == rmh - 1)
+            return true;
+        /* pillars and cell interiors */
+        if ((x & 1) == (y & 1))
+            return !(x & 1);
+        /* wall between two cells */
+        if (x & 1)
+            return wallmap_bit(up_row(y / 2 - 1), x / 2);
+        return wallmap_bit(right_row(y / 2), x / 2 - 1);
+    }
+
+    /* cell view, dir is one of DIR_* */
+    bool wall(int cell, int dir) const {
+        int x = cell % W;
+        int y = cell / W;
+        switch (dir) {
+            case DIR_UP:
+                return y == H - 1 || wallmap_bit(up_row(y), x);
+            case DIR_DOWN:
+                return y == 0 || wallmap_bit(up_row(y - 1), x);
+            case DIR_LEFT:
+                return x == 0 || wallmap_bit(right_row(y), x - 1);
+            default:
+                return x == W - 1 || wallmap_bit(right_row(y), x);
+        }
+    }
+
+    void carve(int cell, int dir) {
+        int x = cell % W;
+        int y = cell / W;
+        switch (dir) {
+            case DIR_UP:
+                assert(y < H - 1);
+                wallmap_clear_bit(up_row(y), x);
+                break;
+            case DIR_DOWN:
+                assert(y > 0);
+                wallmap_clear_bit(up_row(y - 1), x);
+                break;
+            case DIR_LEFT:
+                assert(x > 0);
+                wallmap_clear_bit(right_row(y), x - 1);
+                break;
+            default:
+                assert(x < W - 1);
+                wallmap_clear_bit(right_row(y), x);
+                break;
+        }
+    }
+
+    /* -1 if it is outside the maze; a switch rather than offr/offc so that
+     * constant directions fold */
+    int neighbour(int cell, int dir) const {
+        int x = cell % W;
+        int y = cell / W;
+        switch (dir) {
+            case DIR_UP:
+                return y < H - 1 ? cell + W : -1;
+            case DIR_DOWN:
+                return y > 0 ? cell - W : -1;
+            case DIR_LEFT:
+                return x > 0 ? cell - 1 : -1;
+            default:
+                return x < W - 1 ? cell + 1 : -1;
+        }
+    }
+
+    /* copies a whole row, in the layout of maze_row_t */
+    void store_row(int y, const uint64_t *right, const uint64_t *up) {
+        memcpy(right_row(y), right, words_per_row * sizeof(uint64_t));
+        memcpy(up_row(y), up, words_per_row * sizeof(uint64_t));
+    }
+
+    size_t bytes() const { return sizeof(words); }
+    const uint64_t *data() const { return words.data(); }
+
+    /* raw rows, words_per_row words each */
+    uint64_t *right_row(int y) { return &words[(size_t) y * 2 * words_per_row]; }
+    uint64_t *up_row(int y) { return &words[((size_t) y * 2 + 1) * words_per_row]; }
+    const uint64_t *right_row(int y) const { return &words[(size_t) y * 2 * words_per_row]; }
+    const uint64_t *up_row(int y) const { return &words[((size_t) y * 2 + 1) * words_per_row]; }
+
+private:
+    std::array<uint64_t, (size_t) H * 2 * words_per_row> words;
+};
+
+template <int W, int H>
+constexpr int fixed_wallmap_t<W, H>::width;
+template <int W, int H>
+constexpr int fixed_wallmap_t<W, H>::height;
+template <int W, int H>
+constexpr int fixed_wallmap_t<W, H>::words_per_row;
+template <int W, int H>
+constexpr int fixed_wallmap_t<W, H>::rmw;
+template <int W, int H>
+constexpr int fixed_wallmap_t<W, H>::rmh;
+
+/* maze_t with constant sizes; draw() and draw_hint() live in gamelogic.cpp */
+template <int W, int H>
+class fixed_maze_t {
+public:
+    fixed_maze_t() : seed(0), generator(&generator_list[0]) {
+        mazemap.fill(1);
+    }
+
+    /* the same generator and seed always give the same maze, and the same
+     * maze as maze_t; the distance field is dropped, see solve() */
+    generator_stats_t refresh(uint64_t seed) {
+        this->seed = seed;
+        hint.clear();
+        generator_stats_t stats = generator_run_walls(generator, mazemap, seed);
+        std::vector<int>().swap(distance);
+        std::vector<char>().swap(toward_exit);
+        return stats;
+    }
+    void draw();
+    void draw_hint();
+
+    static constexpr int width = W;
+    static constexpr int height = H;
+    uint64_t seed;
+    const generator_t *generator;
+    fixed_wallmap_t<W, H> mazemap;
+
+    /* fills hint with the path from pos to the exit, building the
+     * distance field first if there is none */
+    void solve(int pos) {
+        if (distance.empty())
+            maze_build_field(*this);
+        maze_solve(*this, pos);
+    }
+
+    std::vector<int> hint;
+    std::vector<int> distance;          //see maze_t
+    std::vector<char> toward_exit;
+};
+
+template <int W, int H>
+constexpr int fixed_maze_t<W, H>::width;
+template <int W, int H>
+constexpr int fixed_maze_t<W, H>::height;
+
+#endif
@@ -2,15 +2,21 @@
 #include <cstdlib>
 #include <cmath>
 
+#include <array>
 #include <vector>
 #include <chrono>
-#include <random>
+#include <utility>
 
 #include "gamelogic.h"
 #include "platform.h"
 #include "graphics.h"
 #include "macro.h"
 #include "input.h"
+#include "maze.h"
+#include "fixedmaze.h"
+#include "generator.h"
+#include "mazefile.h"
+#include "chunk.h"
 
 #include <iostream>
 #include <iomanip>
@@ -46,157 +52,46 @@ framebuffer_t *tempbuffer;
 int color_accent = 0;
 int players = 1;
 int timing = 0;
-
-/* maze management
- *
- * "1" in mazemap stands for walls
- * "0" in mazemap stands for ground
- */
-
-class maze_t {
-public:
-    maze_t();
-    maze_t(int, int);
-    ~maze_t();
-
-    void refresh();
-    void draw();
-    void draw_hint();
-
-    int width;
-    int height;
-    bool *mazemap;
-
-    void dfs(int);
-    vector<int> hint;
-    vector<int> path;
-private:
-    void initialize();
-    void randomize();
-};
-
-maze_t::maze_t() : width(M_W), height(M_H) {
-    int count = (width * 2 + 1) * (height * 2 + 1);
-    this->mazemap = (bool *) malloc(sizeof(bool) * count);
-    path.clear();
-}
-
-maze_t::maze_t(int w, int h) {
-    width = w;
-    height = h;
-    M_W = width;
-    M_H = height;
-    maze_t();
-}
-
-maze_t::~maze_t() {
-    free(this->mazemap);
-}
-
-void maze_t::refresh() {
-    initialize();
-    randomize();
-}
-
-void maze_t::initialize() {
-    int iter = 0;
-    for (int i = 0; i < (height * 2 + 1); ++i) {
-        for (int j = 0; j < (width * 2 + 1); ++j, ++iter) {
-            if (i % 2 == 0 || j % 2 == 0) {
-                this->mazemap[iter] = 1;
-            } else {
-                this->mazemap[iter] = 0;
-            }
-        }
-    }
+const generator_t *generator = &generator_list[0];
+uint64_t next_seed = 0;
+const char *const *maze_files = NULL;
+int maze_file_count = 0;
+int next_maze_file = 0;
+
+/* maze management, see maze.h and fixedmaze.h */
+
+template <class maze_type>
+static void new_maze(maze_type &maze) {
+    maze.generator = generator;
+    generator_stats_t stats = maze.refresh(next_seed++);
+    cout << " " << maze.generator->name << " seed " << maze.seed << " " << maze.width * maze.height << " cells "
+         << fixed << setprecision(0) << stats.cells_per_second << " cells/s " << endl;
 }
 
-/* go          up,          down,       left,       right */
-int offa[4] = {MAZE_WIDTH, -MAZE_WIDTH,     -1,         1};     //offset in vector isaccessed
-int offr[4] = {         1,          -1,      0,         0};     //offset of row     or y
-int offc[4] = {         0,           0,     -1,         1};     //offset of column  or x
-
-void maze_t::randomize() {
-    int maze_size = width * height;
-    /* initiallize random number generators */
-    uint32_t seed = (uint32_t) std::chrono::system_clock::now().time_since_epoch().count();
-    mt19937 rand_num(seed);
-    /* use uniform_int_distribution to yield uniformly distributed random number in an interval */
-    uniform_int_distribution<int> dist(0, maze_size - 1);   //random number within [0, count - 1]
-    uniform_int_distribution<int> dist_0_3(0, 3);       //random number within [0, 3]
-    int cur = dist(rand_num);   //starting point
-
-    vector<int> accessed;               //the points have accessed will be pushed in
-    vector<int> is_accessed(maze_size, 0);   //0 for not accessed yet
-    accessed.push_back(cur);
-    is_accessed[cur] = 1;
-
-    while (accessed.size() < maze_size) {
-        int tx = cur % width;      //abscissa of current point
-        int ty = cur / width;      //ordinate of current point
-        int offs = -1;
-        for (int j = 0; j < 4; ++j) {   //for four directions
-            int around = dist_0_3(rand_num);
-            int nx = tx + offc[around]; //abscissa of new point
-            int ny = ty + offr[around]; //ordinate of new point
-            /* if the new point is within the boundary and not accessed */
-            if (ny >= 0 && nx >= 0 && ny < height && nx < width && !is_accessed[cur + offa[around]]) {
-                offs = around;
-                break;
-            }
-        }
-        /* if all directions have accessed */
-        if (offs < 0) {
-            /* choose an accessed point as current */
-            uniform_int_distribution<int> dist(0, (int) accessed.size() - 1);
-            int tcur = dist(rand_num);
-            cur = accessed[tcur];
-        } else {
-            /* choose a nearby point as current */
-            tx = tx * 2 + 1 + offc[offs];
-            ty = ty * 2 + 1 + offr[offs];
-
-            /* update mazemap*/
-            this->mazemap[ty * (width * 2 + 1) + tx] = 0;
-
-            /* update is_accssed and accessed */
-            cur += offa[offs];
-            is_accessed[cur] = 1;
-            accessed.push_back(cur);
-        }
-    }
-}
-
-void maze_t::dfs(int pos) {
-    if (pos == 4 * width) {
-        hint.assign(path.begin(), path.end());
-        return;
-    }
-    int y = pos / RMW;
-    int x = pos % RMW;
-    for (int i = 0; i < 4; ++i) {
-        int nx = x + offc[i]; //abscissa of new point
-        int ny = y + offr[i]; //ordinate of new point
-
-        /* if the new point is within the boundary */
-        if (ny >= 0 && nx >= 0 && ny < RMH && nx < RMW) {
-            if (!mazemap[ny * RMW + nx] && (find(path.begin(), path.end(), ny * RMW + nx) == path.end())) {
-                path.push_back(ny * RMW + nx);
-                dfs(ny * RMW + nx);
-                path.pop_back();
-            }
+static void new_maze(maze_t &maze) {
+    /* pre-generated mazes first, in turn */
+    if (maze_file_count > 0) {
+        const char *filename = maze_files[next_maze_file++ % maze_file_count];
+        if (mazefile_load(maze, filename)) {
+            M_W = maze.width;
+            M_H = maze.height;
+            cout << " " << filename << " seed " << maze.seed << " " << maze.width * maze.height << " cells " << endl;
+            return;
         }
+        cout << " can not load " << filename << endl;
     }
-    return;
+    new_maze<maze_t>(maze);
 }
 
 float box_length_rate = 0.8;
 float filleted_rate = 0.2;
 float ele_size;
 float spx, spy;
+tile_cache_t *box_tiles = NULL;         //walls and hints all have the same box, see draw_filleted_box_cached
 
-void maze_t::draw() {
-    int rmw = RMW, rwh = RMH;
+/* lays rmw x rwh expanded cells out in the maze area: sets ele_size, spx,
+ * spy and the box of the walls and hints */
+static void layout_maze(int rmw, int rwh) {
     /* if maze_width is much longer */
     if ((float) rmw / rwh > MA_W / MA_H) {
         ele_size = MA_W / rmw;
@@ -210,42 +105,74 @@ void maze_t::draw() {
 
     float box_length = ele_size * box_length_rate;
     float fl = filleted_rate * box_length;
+    box_tiles = tile_cache_update(box_tiles, box_length, box_length, fl);
+}
+
+/* draws the expanded cells (x, y) of the maze area for which wall(x, y) is true */
+template <class wall_fn>
+static void draw_walls(int rmw, int rwh, const wall_fn &wall) {
+    layout_maze(rmw, rwh);
     for (int i = 0; i < rwh; ++i) {
         for (int j = 0; j < rmw; ++j) {
-            if (this->mazemap[i * rmw + j])
-                draw_filleted_box(MM_L + spx + j * ele_size, MM_B + spy + i * ele_size, 0, box_length, box_length, fl,
-                                  color_accent_list_maze[color_accent]);
+            if (wall(j, i))
+                draw_filleted_box_cached(box_tiles, MM_L + spx + j * ele_size, MM_B + spy + i * ele_size,
+                                         color_accent_list_maze[color_accent]);
         }
     }
 }
 
-void maze_t::draw_hint() {
-    int rmw = RMW, rwh = RMH;
-    /* if maze_width is much longer */
-    if ((float) rmw / rwh > MA_W / MA_H) {
-        ele_size = MA_W / rmw;
-        spx = ele_size / 2;
-        spy = (MA_H - ele_size * rwh) / 2 + spx;
-    } else {
-        ele_size = MA_H / rwh;
-        spy = ele_size / 2;
-        spx = (MA_W - ele_size * rmw) / 2 + spy;
-    }
-
-    float box_length = ele_size * box_length_rate;
-    float fl = filleted_rate * box_length;
+template <class maze_type>
+static void draw_maze(const maze_type &maze) {
+    int rmw = maze.width * 2 + 1;
+    draw_walls(rmw, maze.height * 2 + 1, [&](int x, int y) { return maze.mazemap[y * rmw + x]; });
+}
 
-    for (int it : hint) {
+template <class maze_type>
+static void draw_maze_hint(const maze_type &maze) {
+    int rmw = maze.width * 2 + 1;
+    layout_maze(rmw, maze.height * 2 + 1);
+    for (int it : maze.hint) {
         int i = it / rmw;
         int j = it % rmw;
 #ifdef DEBUG
         cout << "DRAW" << i << " " << j << endl;
 #endif
-        draw_filleted_box(MM_L + spx + j * ele_size, MM_B + spy + i * ele_size, 0, box_length, box_length, fl,
-                          color_accent_list_hint[color_accent]);
+        draw_filleted_box_cached(box_tiles, MM_L + spx + j * ele_size, MM_B + spy + i * ele_size,
+                                 color_accent_list_hint[color_accent]);
     }
 }
 
+/* one position of the hint, drawn or rubbed out again, in the layout of the
+ * last draw_maze(); the neighbouring walls keep a margin of their own */
+static void draw_hint_cell(int rmw, int pos, bool on) {
+    float box_length = ele_size * box_length_rate;
+    float cx = MM_L + spx + pos % rmw * ele_size;
+    float cy = MM_B + spy + pos / rmw * ele_size;
+    if (on) {
+        box_tiles = tile_cache_update(box_tiles, box_length, box_length, filleted_rate * box_length);
+        draw_filleted_box_cached(box_tiles, cx, cy, color_accent_list_hint[color_accent]);
+    } else
+        draw_box(cx, cy, 0, ele_size, ele_size, color_accent_list_box[color_accent]);
+}
+
+void maze_t::draw() {
+    draw_maze(*this);
+}
+
+void maze_t::draw_hint() {
+    draw_maze_hint(*this);
+}
+
+template <int W, int H>
+void fixed_maze_t<W, H>::draw() {
+    draw_maze(*this);
+}
+
+template <int W, int H>
+void fixed_maze_t<W, H>::draw_hint() {
+    draw_maze_hint(*this);
+}
+
 /* mouse management */
 class mouse_t {
 public:
@@ -256,7 +183,8 @@ public:
     float p_x;
     float p_y;
     bool is_moving = 0;
-    int to_move = -1;
+    int to_move = -1;                   //DIR_* while is_moving
+    float move_start = 0;               //when is_moving began
 
     ivec4_t AABB();
 
@@ -317,45 +245,157 @@ void mouse_t::set_color(vec3_t in_color) {
     color = in_color;
 }
 
-int in_game_loop(window_t *window) {
-    maze_t maze;
-    mouse_t mouse;
+/* the keys of the players by DIR_*: with one player both sets move it,
+ * with two the second one has the arrows, and with more shift hands W, A,
+ * S, D on to the next of the others in turn */
+static const int wasd_keys[4] = {KEY_W, KEY_S, KEY_A, KEY_D};
+static const int arrow_keys[4] = {KEY_UP, KEY_DOWN, KEY_LEFT, KEY_RIGHT};
+
+/* the DIR_* a mouse is asked to move in, -1 if none; keys are tried left,
+ * down, right, up, and wall(x, y) tells the expanded cells of the window */
+template <class wall_fn>
+static int wanted_move(const wall_fn &wall, const record_t &record, const mouse_t &mouse, bool wasd, bool arrows) {
+    static const int order[4] = {DIR_LEFT, DIR_DOWN, DIR_RIGHT, DIR_UP};
+    for (int dir : order) {
+        bool pressed = (wasd && record.key[wasd_keys[dir]]) || (arrows && record.key[arrow_keys[dir]]);
+        if (pressed && !wall(mouse.x + offc[dir], mouse.y + offr[dir]))
+            return dir;
+    }
+    return -1;
+}
 
-#ifdef DEBUG
-    cout << RMW << " " << RMW << endl;
-#endif
+/* starts the steps the players ask for and ends those that took
+ * mouse_moving_interval, calling arrived(mouse, from_x, from_y) after each;
+ * prev_time is when the last step began. returns true if the mice have to
+ * be presented again */
+template <class wall_fn, class arrived_fn>
+static bool step_mice(vector<mouse_t> &mice, const record_t &record, float curr_time, int wasd_player,
+                      const wall_fn &wall, float &prev_time, const arrived_fn &arrived) {
+    int count = (int) mice.size();
+    bool dirty = false;
+    for (int i = 0; i < count; ++i) {
+        mouse_t &mouse = mice[i];
+        if (!mouse.is_moving) {
+            int dir = wanted_move(wall, record, mouse, i == wasd_player, count == 1 || i == 1);
+            if (dir >= 0) {
+                mouse.to_move = dir;
+                mouse.is_moving = 1;
+                mouse.move_start = curr_time;
+                prev_time = curr_time;
+            }
+        } else if (curr_time - mouse.move_start >= mouse_moving_interval) {
+            int from_x = mouse.x, from_y = mouse.y;
+            mouse.is_moving = 0;
+            mouse.move(offc[mouse.to_move], offr[mouse.to_move]);
+            arrived(mouse, from_x, from_y);
+            dirty = true;
+        }
+        dirty = dirty || mouse.is_moving;
+    }
+    return dirty;
+}
 
-    /* show maze area */
-    draw_box((MM_R + MM_L) / 2, (MM_T + MM_B) / 2, 0, MM_R - MM_L, MM_T - MM_B, vec3_new(0.1, 0.12, 0.15));
-    maze.refresh();
-    maze.draw();
+/* shows the framebuffer with the mice on it and takes them off again; every
+ * background is saved before any mouse is drawn, as mice may overlap */
+static void present_mice(window_t *window, vector<mouse_t> &mice, float curr_time) {
+    vector<ivec4_t> boxes;
+    for (mouse_t &mouse : mice) {
+        boxes.push_back(mouse.AABB());
+        framebuffer_copy(tempbuffer, framebuffer, boxes.back());
+    }
+    for (mouse_t &mouse : mice) {
+        if (mouse.is_moving)
+            mouse.draw(curr_time - mouse.move_start);
+        else
+            mouse.draw();
+    }
+    window_draw_buffer(window, framebuffer);
+    for (const ivec4_t &box : boxes)
+        framebuffer_copy(framebuffer, tempbuffer, box);
+}
 
-    record_t record;
+/* count mice, all in the centre */
+static void place_mice(vector<mouse_t> &mice, int count) {
+    mice.assign(count, mouse_t());
+    for (int i = 0; i < count; ++i) {
+        if (i > 0)
+            mice[i].set_color(color_list_players[(i - 1) % ARRAY_SIZE(color_list_players)]);
+        mice[i].move(0, 0);
+    }
+}
+
+/* redraws the positions of changed as they are now on or off the hints */
+static void draw_cover(int rmw, const hint_cover_t &cover, const vector<int> &changed) {
+    for (int pos : changed)
+        draw_hint_cell(rmw, pos, cover.covered(pos));
+}
+
+/* the background of the maze area with draw() on it, as one batch */
+template <class draw_fn>
+static void show_maze_area(vec3_t background, const draw_fn &draw) {
+    graphics_begin_batch();
+    draw_box((MM_R + MM_L) / 2, (MM_T + MM_B) / 2, 0, MM_R - MM_L, MM_T - MM_B, background);
+    draw();
+    graphics_end_batch();
+}
+
+/* the keys and clicks of window go to record */
+static void listen_input(window_t *window, record_t &record) {
     memset(&record, 0, sizeof(record_t));
     callbacks_t callbacks;
     memset(&callbacks, 0, sizeof(callbacks_t));
     callbacks.button_callback = button_callback;
     window_set_userdata(window, &record);
     input_set_callbacks(window, callbacks);
+}
+
+/* forgets the keys and clicks of this frame and takes those of the next */
+static void next_input(record_t &record) {
+    record.single_click = 0;
+    record.double_click = 0;
+    memset(record.key, 0, sizeof(record.key));
+    input_poll_events();
+}
+
+template <class maze_type>
+int in_game_loop(window_t *window, maze_type &maze) {
+    auto wall = [&](int x, int y) { return maze.mazemap[y * (maze.width * 2 + 1) + x]; };
+    auto show_maze = [&]() { maze.draw(); };
+
+    /* show maze area */
+    new_maze(maze);
+    show_maze_area(vec3_new(0.1, 0.12, 0.15), show_maze);
+
+    /* the maze may come from a file of another size, so place the mice after it */
+    vector<mouse_t> mice;
+    place_mice(mice, players);
+
+#ifdef DEBUG
+    cout << RMW << " " << RMW << endl;
+#endif
+
+    record_t record;
+    listen_input(window, record);
 
     bool acc_key = 1;
     float prev_time = platform_get_time();
-    float print_time = prev_time;
     bool is_hinted = false;
+    hint_cover_t cover;                 //the hints of all the mice while is_hinted
+    vector<int> changed;
+    int wasd_player = 0;                //the player on W, A, S, D
+    cover.reset((maze.width * 2 + 1) * (maze.height * 2 + 1));
 
-    mouse.move(0, 0);
-    framebuffer_copy(tempbuffer, framebuffer, mouse.AABB());
-    mouse.draw();
-    window_draw_buffer(window, framebuffer);
-    framebuffer_copy(framebuffer, tempbuffer, mouse.AABB());
+    present_mice(window, mice, prev_time);
 
     float start_time = platform_get_time();
     float hint_prev_time = platform_get_time();
     float new_prev_time = platform_get_time();
+    float shift_prev_time = platform_get_time();
     while (!window_should_close(window)) {
 
         float curr_time = platform_get_time();
         float delta_time = curr_time - prev_time;
+        int rmw = maze.width * 2 + 1;
 
 
         update_click(curr_time, &record);
@@ -371,68 +411,34 @@ int in_game_loop(window_t *window) {
             acc_key = 1;
         }
 
-        // navigate with A, W, S, D or arrow keys
-        if (!mouse.is_moving && acc_key) {
-            bool is_acc = 0;
-            if ((record.key[KEY_A] || record.key[KEY_LEFT]) && !maze.mazemap[mouse.y * RMW + mouse.x - 1]) {
-                mouse.to_move = 2;
-                is_acc = 1;
-            } else if ((record.key[KEY_S] || record.key[KEY_DOWN]) && !maze.mazemap[(mouse.y - 1) * RMW + mouse.x]) {
-                mouse.to_move = 1;
-                is_acc = 1;
-            } else if ((record.key[KEY_D] || record.key[KEY_RIGHT]) && !maze.mazemap[mouse.y * RMW + mouse.x + 1]) {
-                mouse.to_move = 3;
-                is_acc = 1;
-            } else if ((record.key[KEY_W] || record.key[KEY_UP]) && !maze.mazemap[(mouse.y + 1) * RMW + mouse.x]) {
-                mouse.to_move = 0;
-                is_acc = 1;
-            }
-
-            if (is_acc) {
-                mouse.is_moving = 1;
-                prev_time = curr_time;
-                print_time = curr_time;
-                acc_key = 0;
-            }
-        }
-        if (mouse.is_moving) {
-            if (curr_time - print_time >= mouse_moving_interval) {
-                mouse.is_moving = 0;
-                mouse.move(offc[mouse.to_move], offr[mouse.to_move]);
+        // navigate with A, W, S, D or arrow keys, see wasd_keys
+        bool dirty = step_mice(mice, record, curr_time, wasd_player, wall, prev_time,
+                               [&](const mouse_t &mouse, int from_x, int from_y) {
 #ifdef DEBUG
-                cout << mouse.x << " " << mouse.y << endl;
+            cout << mouse.x << " " << mouse.y << endl;
 #endif
-            } else {
-                ivec4_t AABB = mouse.AABB();
-                framebuffer_copy(tempbuffer, framebuffer, AABB);
-                mouse.draw(curr_time - print_time);
-                window_draw_buffer(window, framebuffer);
-                framebuffer_copy(framebuffer, tempbuffer, AABB);
+            if (is_hinted) {
+                /* only the positions that joined or left the hints change */
+                changed.clear();
+                cover.move(maze, from_y * rmw + from_x, mouse.y * rmw + mouse.x, changed);
+                draw_cover(rmw, cover, changed);
             }
-        }
+        });
 
         /* return is pressed = new game */
         if (record.key[KEY_RETURN] && acc_key && curr_time - new_prev_time >= key_interval) {
             cout << " new game " << endl;
-            draw_box((MM_R + MM_L) / 2, (MM_T + MM_B) / 2, 0, MM_R - MM_L, MM_T - MM_B, vec3_new(0.1, 0.12, 0.15));
-            maze.refresh();
-            maze.draw();
-
+            new_maze(maze);
+            show_maze_area(vec3_new(0.1, 0.12, 0.15), show_maze);
             memset(&record, 0, sizeof(record_t));
-            memset(&callbacks, 0, sizeof(callbacks_t));
-            callbacks.button_callback = button_callback;
 
             acc_key = 1;
             prev_time = platform_get_time();
-            print_time = prev_time;
             is_hinted = false;
+            cover.reset((maze.width * 2 + 1) * (maze.height * 2 + 1));
 
-            mouse = mouse_t();          // move the mouse to center
-            mouse.move(0, 0);
-            framebuffer_copy(tempbuffer, framebuffer, mouse.AABB());
-            mouse.draw();
-            window_draw_buffer(window, framebuffer);
-            framebuffer_copy(framebuffer, tempbuffer, mouse.AABB());
+            place_mice(mice, players);  // move the mice to center
+            present_mice(window, mice, prev_time);
 
             start_time = platform_get_time();
             hint_prev_time = platform_get_time();
@@ -446,65 +452,169 @@ int in_game_loop(window_t *window) {
             return 0;
         }
 
-        /* space is pressed = hint */
+        /* shift is pressed = W, A, S, D to the next player but the one on the arrows */
+        if (players > 2 && record.key[KEY_SHIFT] && curr_time - shift_prev_time >= key_interval) {
+            shift_prev_time = curr_time;
+            wasd_player = (wasd_player + 1) % players;
+            if (wasd_player == 1)
+                wasd_player = 2;
+            cout << " player " << wasd_player + 1 << " on W, A, S, D " << endl;
+        }
+
+        /* space is pressed = hint, for every mouse at once */
         if (record.key[KEY_SPACE] && acc_key && curr_time - hint_prev_time >= key_interval) {
             hint_prev_time = curr_time;
             is_hinted = !is_hinted;
+            changed.clear();
             if (is_hinted) {
                 cout << " hint " << endl;
-                maze.path.clear();
-                maze.path.push_back(mouse.y * RMW + mouse.x);
-                maze.dfs(mouse.y * RMW + mouse.x);
-#ifdef DEBUG
-                for (auto it = maze.hint.begin(); it < maze.hint.end(); ++it) {
-                    cout << *it << " ";
-                }
-                cout << endl;
-#endif
-                maze.draw_hint();
-
-                ivec4_t AABB = mouse.AABB();
-                framebuffer_copy(tempbuffer, framebuffer, AABB);
-                mouse.draw();
-                window_draw_buffer(window, framebuffer);
-                framebuffer_copy(framebuffer, tempbuffer, AABB);
+                /* the field is only built for the hints */
+                if (maze.distance.empty())
+                    maze_build_field(maze);
+                for (const mouse_t &mouse : mice)
+                    cover.add(maze, mouse.y * rmw + mouse.x, changed);
             } else {
-                for (int i = 0; i < W_W * W_H; ++i)
-                    framebuffer->colorbuffer[i] = color_accent_list_bg[color_accent];
-                /* show maze area */
-                draw_box((MM_R + MM_L) / 2, (MM_T + MM_B) / 2, 0, MM_R - MM_L, MM_T - MM_B,
-                         color_accent_list_box[color_accent]);
-
-                maze.draw();
-
-                ivec4_t AABB = mouse.AABB();
-                framebuffer_copy(tempbuffer, framebuffer, AABB);
-                mouse.draw();
-                window_draw_buffer(window, framebuffer);
-                framebuffer_copy(framebuffer, tempbuffer, AABB);
+                /* rub out the hints alone */
+                for (const mouse_t &mouse : mice)
+                    cover.remove(maze, mouse.y * rmw + mouse.x, changed);
             }
+            graphics_begin_batch();
+            draw_cover(rmw, cover, changed);
+            graphics_end_batch();
+            dirty = true;
             acc_key = 0;
         }
 
+        if (dirty)
+            present_mice(window, mice, curr_time);
+
         /* if reaches end */
-        if (mouse.x + 2 == RMW && mouse.y - 1 == 0) {
-            cout << " win " << endl;
-            if (timing) cout << " " << fixed << setprecision(2) << curr_time - start_time << endl;
+        for (int i = 0; i < players; ++i) {
+            if (mice[i].x + 2 == maze.width * 2 + 1 && mice[i].y - 1 == 0) {
+                if (players > 1)
+                    cout << " player " << i + 1 << " wins " << endl;
+                else
+                    cout << " win " << endl;
+                if (timing) cout << " " << fixed << setprecision(2) << curr_time - start_time << endl;
+                return 1;
+            }
+        }
+        next_input(record);
+    }
+    return 0;
+}
+
+
+/* infinite world, see chunk.h
+ *
+ * the window shows RMW x RMH expanded cells of the world starting at the even
+ * position (ox, oy); mouse.x and mouse.y stay window positions and the view
+ * is moved under the mouse when it walks close to an edge.
+ */
+size_t world_budget = 16 << 20;     //bytes of chunks kept around the mouse
+
+/* moves the view by an even amount so that pos comes back to the middle */
+static int recentre(int pos, int size, long long &origin) {
+    int margin = size / 4;
+    if (pos >= margin && pos < size - margin)
+        return 0;
+    int delta = (pos - size / 2) & ~1;
+    origin += delta;
+    return delta;
+}
+
+int in_world_loop(window_t *window) {
+    world_t world(next_seed++, generator, world_budget);
+    long long ox = 0, oy = 0;
+    cout << " world seed " << world.seed << endl;
+    auto wall = [&](int x, int y) { return world(ox + x, oy + y); };
+    auto show_world = [&]() {
+        framebuffer_clear_color(framebuffer, color_accent_list_bg[color_accent]);
+        show_maze_area(color_accent_list_box[color_accent], [&]() { draw_walls(RMW, RMH, wall); });
+    };
+
+    /* show maze area */
+    show_world();
+    vector<mouse_t> mice;
+    place_mice(mice, 1);
+
+    record_t record;
+    listen_input(window, record);
+
+    float prev_time = platform_get_time();
+    present_mice(window, mice, prev_time);
+
+    float new_prev_time = platform_get_time();
+    while (!window_should_close(window)) {
+        float curr_time = platform_get_time();
+
+        update_click(curr_time, &record);
+        update_key(window, curr_time, &record);
+
+        // navigate with A, W, S, D or arrow keys, see wasd_keys
+        bool dirty = step_mice(mice, record, curr_time, 0, wall, prev_time, [&](mouse_t &mouse, int, int) {
+            /* walked close to an edge: move the view and redraw it */
+            int dx = recentre(mouse.x, RMW, ox);
+            int dy = recentre(mouse.y, RMH, oy);
+            if (dx || dy) {
+                show_world();
+                mouse.move(-dx, -dy);
+#ifdef DEBUG
+                cout << world.chunk_count() << " chunks " << world.bytes() << " bytes" << endl;
+#endif
+            }
+        });
+        if (dirty)
+            present_mice(window, mice, curr_time);
+
+        /* return is pressed = new world */
+        if (record.key[KEY_RETURN] && curr_time - new_prev_time >= key_interval) {
+            cout << " new world " << endl;
             return 1;
         }
-        record.single_click = 0;
-        record.double_click = 0;
-        memset(record.key, 0, sizeof(record.key));
-        input_poll_events();
+
+        /* esc is pressed = quit */
+        if (record.key[KEY_ESCAPE]) {
+            cout << " quit " << endl;
+            return 0;
+        }
+
+        next_input(record);
     }
     return 0;
 }
 
+/* plays difficulty_list[P] on its compile-time sized maze */
+template <size_t P>
+static void play_preset(window_t *window) {
+    fixed_maze_t<difficulty_list[P].x, difficulty_list[P].y> maze;
+    while (in_game_loop(window, maze)) {
+        cout << " restart " << endl;
+    }
+}
+
+/* &play_preset<P> for every P of difficulty_list, by P */
+template <size_t... P>
+static constexpr array<void (*)(window_t *), sizeof...(P)> preset_players(index_sequence<P...>) {
+    return {{&play_preset<P>...}};
+}
 
-void main_loop(int difficulty, int color_accent, int players, int timing) {
+void main_loop(int difficulty, int color_accent, int players, int timing, const char *generator, long long seed,
+               const char *const *maze_files, int maze_file_count, int infinite, int rgba8) {
     ::color_accent = color_accent;
     ::players = players;
     ::timing = timing;
+    ::generator = generator_find(generator);
+    if (::generator == NULL) {
+        cout << " unknown generator " << generator << ", using " << generator_list[0].name << endl;
+        ::generator = &generator_list[0];
+    }
+    ::maze_files = maze_files;
+    ::maze_file_count = maze_file_count;
+    if (seed < 0)
+        next_seed = (uint64_t) std::chrono::system_clock::now().time_since_epoch().count();
+    else
+        next_seed = (uint64_t) seed;
     window_t *window;
     M_W = difficulty_list[difficulty].x;
     M_H = difficulty_list[difficulty].y;
@@ -517,17 +627,26 @@ void main_loop(int difficulty, int color_accent, int players, int timing) {
     maze_area_width = maze_margin_right - maze_margin_left;
     maze_area_height = maze_margin_top - maze_margin_bottom;
 
-    offa[0] = M_W;
-    offa[1] = -M_W;
-
     window = window_create("Maze", W_W, W_H);
-    framebuffer = framebuffer_create(W_W, W_H);
-    tempbuffer = framebuffer_create(W_W, W_H);
-    for (int i = 0; i < W_W * W_H; ++i)
-        framebuffer->colorbuffer[i] = color_accent_list_bg[color_accent];
+    framebuffer = framebuffer_create(W_W, W_H, rgba8 ? FRAMEBUFFER_BGRA8 : FRAMEBUFFER_FLOAT);
+    tempbuffer = framebuffer_create(W_W, W_H, framebuffer->format);
+    framebuffer_clear_color(framebuffer, color_accent_list_bg[color_accent]);
 
-    while (in_game_loop(window)) {
-        cout << " restart " << endl;
+    if (infinite) {
+        while (in_world_loop(window)) {
+            cout << " restart " << endl;
+        }
+    } else if (maze_file_count > 0) {
+        /* files may be of any size */
+        maze_t maze(M_W, M_H);
+        while (in_game_loop(window, maze)) {
+            cout << " restart " << endl;
+        }
+    } else {
+        /* one instance per entry of difficulty_list, the last one past its end */
+        static constexpr size_t presets = ARRAY_SIZE(difficulty_list);
+        static constexpr array<void (*)(window_t *), presets> play = preset_players(make_index_sequence<presets>());
+        play[(size_t) difficulty < presets ? (size_t) difficulty : presets - 1](window);
     }
     window_destroy(window);
 }
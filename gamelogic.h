@@ -7,17 +7,18 @@ extern framebuffer_t *framebuffer;
 extern int WINDOW_WIDTH;
 extern int WINDOW_HEIGHT;
 // MAZE_WIDTH, MAZE_HEIGHT, WINDOW_WIDTH, WINDOW_HEIGHT
-const ivec4_t difficulty_list[] = {
-        ivec4_new(2, 2, 300, 300),
-        ivec4_new(10, 5, 500, 300),
-        ivec4_new(20, 10, 600, 400),
-        ivec4_new(20, 20, 600, 600),
-        ivec4_new(30, 30, 700, 700),
-        ivec4_new(40, 20, 800, 600),
-        ivec4_new(40, 20, 1000, 800),
-        ivec4_new(40, 40, 1000, 800),
-        ivec4_new(45, 45, 1000, 800),
-        ivec4_new(50, 50, 1200, 1200)
+// constexpr: the game instantiates a fixed_maze_t per entry, see main_loop
+constexpr ivec4_t difficulty_list[] = {
+        {2, 2, 300, 300},
+        {10, 5, 500, 300},
+        {20, 10, 600, 400},
+        {20, 20, 600, 600},
+        {30, 30, 700, 700},
+        {40, 20, 800, 600},
+        {40, 20, 1000, 800},
+        {40, 40, 1000, 800},
+        {45, 45, 1000, 800},
+        {50, 50, 1200, 1200}
 };
 
 const vec4_t color_accent_list_bg[] = {
@@ -85,6 +86,25 @@ const vec3_t color_accent_list_hint[] = {
         vec3_new(0.4,0.12,0.15)
 };
 
-void main_loop(int difficulty = 0 , int color_accent = 0, int players = 1, int timing = 0);
+/* the mice of the players after the first, which has the accent's */
+const vec3_t color_list_players[] = {
+        vec3_new(0.2, 0.6, 0.9),
+        vec3_new(0.9, 0.7, 0.2),
+        vec3_new(0.3, 0.8, 0.3),
+        vec3_new(0.8, 0.3, 0.8)
+};
+
+/* mazes use seed, seed + 1, ... in turn; a negative seed takes one from the clock.
+ * if maze_files are given, games load them in turn instead of generating.
+ * infinite plays an unbounded world generated around the mouse, see chunk.h.
+ * players share the maze: W, A, S, D for the first, the arrows for the
+ * second, shift hands W, A, S, D on when there are more (the infinite world
+ * has one player).
+ * rgba8 draws into 8 bit per channel framebuffers instead of float ones,
+ * see framebuffer_format_t */
+void main_loop(int difficulty = 0 , int color_accent = 0, int players = 1, int timing = 0,
+               const char *generator = "prim", long long seed = -1,
+               const char *const *maze_files = 0, int maze_file_count = 0, int infinite = 0,
+               int rgba8 = 0);
 
 #endif /* gamelogic_hpp */
@@ -0,0 +1,133 @@
+#include <cassert>
+#include <cstring>
+
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#include "generator.h"
+#include "generator_impl.h"
+#include "macro.h"
+
+using namespace std;
+
+/* made from GENERATOR_LIST, see generator_impl.h */
+#define GENERATOR_ENTRY(name) {#name, generate_##name<wallmap_t>},
+const generator_t generator_list[] = {GENERATOR_LIST(GENERATOR_ENTRY)};
+#undef GENERATOR_ENTRY
+
+const int generator_count = ARRAY_SIZE(generator_list);
+
+const generator_t *generator_find(const char *name) {
+    for (int i = 0; i < generator_count; ++i)
+        if (strcmp(generator_list[i].name, name) == 0)
+            return &generator_list[i];
+    return NULL;
+}
+
+generator_stats_t generator_run(const generator_t *generator, wallmap_t &walls, uint64_t seed) {
+    return generator_run_walls(generator, walls, seed);
+}
+
+/* tiled generation */
+
+typedef struct {
+    const generator_t *generator;
+    wallmap_t *walls;
+    uint64_t seed;
+    int tile_size;
+    int tiles_x;
+    int tiles_y;
+    atomic<int> next_tile;
+} tiled_job_t;
+
+static void generate_tiles(tiled_job_t *job) {
+    wallmap_t tile;
+    wallmap_t &walls = *job->walls;
+    int tile_count = job->tiles_x * job->tiles_y;
+    for (int t = job->next_tile++; t < tile_count; t = job->next_tile++) {
+        int x0 = t % job->tiles_x * job->tile_size;
+        int y0 = t / job->tiles_x * job->tile_size;
+        int w = min(job->tile_size, walls.width - x0);
+        int h = min(job->tile_size, walls.height - y0);
+        if (tile.width != w || tile.height != h)
+            tile.resize(w, h);
+        generator_run(job->generator, tile, job->seed + rng_t::splitmix64((uint64_t) t));
+
+        /* tiles start on a word boundary and keep their border walls closed */
+        int word = x0 / 64;
+        for (int y = 0; y < h; ++y) {
+            memcpy(walls.right_row(y0 + y) + word, tile.right_row(y), tile.words_per_row * sizeof(uint64_t));
+            memcpy(walls.up_row(y0 + y) + word, tile.up_row(y), tile.words_per_row * sizeof(uint64_t));
+        }
+    }
+}
+
+generator_stats_t generator_run_tiled(const generator_t *generator, wallmap_t &walls, uint64_t seed,
+                                      int threads, int tile_size) {
+    generator_stats_t stats;
+    tiled_job_t job;
+
+    assert(generator != NULL && tile_size > 0);
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    if (threads <= 0)
+        threads = max(1, (int) thread::hardware_concurrency());
+    job.generator = generator;
+    job.walls = &walls;
+    job.seed = seed;
+    job.tile_size = (tile_size + 63) / 64 * 64;
+    job.tiles_x = (walls.width + job.tile_size - 1) / job.tile_size;
+    job.tiles_y = (walls.height + job.tile_size - 1) / job.tile_size;
+    job.next_tile = 0;
+
+    vector<thread> workers;
+    for (int i = 1; i < min(threads, job.tiles_x * job.tiles_y); ++i)
+        workers.push_back(thread(generate_tiles, &job));
+    generate_tiles(&job);
+    for (thread &worker : workers)
+        worker.join();
+
+    /* stitch: Kruskal over the tile grid, one random opening per joined border */
+    rng_t rand_num(seed);
+    int tile_count = job.tiles_x * job.tiles_y;
+    vector<int> edges;                  //tile * 2 + 0 for its right border, + 1 for its up border
+    for (int t = 0; t < tile_count; ++t) {
+        if (t % job.tiles_x < job.tiles_x - 1)
+            edges.push_back(t * 2);
+        if (t / job.tiles_x < job.tiles_y - 1)
+            edges.push_back(t * 2 + 1);
+    }
+    for (int i = (int) edges.size() - 1; i > 0; --i)
+        swap(edges[i], edges[rand_num.bounded(i + 1)]);
+
+    vector<int> parent(tile_count);
+    for (int i = 0; i < tile_count; ++i)
+        parent[i] = i;
+    for (int edge : edges) {
+        int t = edge / 2;
+        int next = (edge & 1) ? t + job.tiles_x : t + 1;
+        int a = find_set(parent, t);
+        int b = find_set(parent, next);
+        if (a == b)
+            continue;
+        parent[b] = a;
+        int x0 = t % job.tiles_x * job.tile_size;
+        int y0 = t / job.tiles_x * job.tile_size;
+        if (edge & 1) {
+            int w = min(job.tile_size, walls.width - x0);
+            int x = x0 + (int) rand_num.bounded(w);
+            walls.carve((y0 + job.tile_size - 1) * walls.width + x, DIR_UP);
+        } else {
+            int h = min(job.tile_size, walls.height - y0);
+            int y = y0 + (int) rand_num.bounded(h);
+            walls.carve(y * walls.width + x0 + job.tile_size - 1, DIR_RIGHT);
+        }
+    }
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+    stats.seconds = elapsed.count();
+    stats.cells_per_second = stats.seconds > 0 ? walls.width * (double) walls.height / stats.seconds : 0;
+    return stats;
+}
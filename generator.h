@@ -0,0 +1,44 @@
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include <cstdint>
+
+#include "wallmap.h"
+#include "rng.h"
+
+/* maze generators
+ *
+ * every generator turns a wallmap_t with all walls closed into a perfect
+ * maze, i.e. exactly one path between any two cells.
+ */
+typedef struct {
+    const char *name;
+    void (*generate)(wallmap_t &walls, rng_t &rand_num);
+} generator_t;
+
+typedef struct {
+    double seconds;
+    double cells_per_second;
+} generator_stats_t;
+
+extern const generator_t generator_list[];
+extern const int generator_count;
+
+/* returns NULL if there is no generator called name */
+const generator_t *generator_find(const char *name);
+
+/* closes every wall of walls, then generates and times the maze,
+ * the same generator and seed always give the same maze */
+generator_stats_t generator_run(const generator_t *generator, wallmap_t &walls, uint64_t seed);
+
+/* generates one maze on several threads: the grid is cut into tiles of about
+ * tile_size x tile_size cells, each tile is generated on its own by a worker,
+ * then the tiles are joined through one opening per edge of a random spanning
+ * tree over the tile grid, so the result is still a perfect maze.
+ * tile_size is rounded up to a multiple of 64 so tiles own whole words of
+ * every row; threads <= 0 uses every hardware thread. the result depends on
+ * seed and tile_size, not on threads */
+generator_stats_t generator_run_tiled(const generator_t *generator, wallmap_t &walls, uint64_t seed,
+                                      int threads, int tile_size = 256);
+
+#endif
@@ -0,0 +1,281 @@
+#ifndef GENERATOR_IMPL_H
+#define GENERATOR_IMPL_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include "wallmap.h"
+#include "rng.h"
+#include "eller.h"
+#include "generator.h"
+
+/* the generators of generator_list, written once for any wall storage
+ *
+ * walls_type is wallmap_t for the mazes sized at run time and
+ * fixed_wallmap_t<W, H> (fixedmaze.h) for the difficulty presets, where the
+ * compiler sees constant sizes and folds the index math away. both give the
+ * same maze for the same generator and seed.
+ */
+
+/* collects the directions from cell to neighbours whose state is wanted */
+template <class walls_type>
+int neighbours_in(const walls_type &walls, int cell, const std::vector<char> &state, char wanted, int *dirs) {
+    int n = 0;
+    for (int j = 0; j < 4; ++j) {
+        int next = walls.neighbour(cell, j);
+        if (next >= 0 && state[next] == wanted)
+            dirs[n++] = j;
+    }
+    return n;
+}
+
+/* randomized Prim: every cell enters the frontier once and leaves it once,
+ * so the whole generation is O(width * height) with no retries */
+template <class walls_type>
+void generate_prim(walls_type &walls, rng_t &rand_num) {
+    int maze_size = walls.width * walls.height;
+    std::vector<char> state(maze_size, 0);   //0 for untouched, 1 for in frontier, 2 for in maze
+    std::vector<int> frontier;               //cells next to the maze but not in it yet
+    frontier.reserve(maze_size);
+    int offs[4];                        //directions leading from a frontier cell into the maze
+    int cur = rand_num.bounded(maze_size);
+
+    while (true) {
+        state[cur] = 2;
+        for (int j = 0; j < 4; ++j) {   //push the untouched neighbours into the frontier
+            int next = walls.neighbour(cur, j);
+            if (next >= 0 && !state[next]) {
+                state[next] = 1;
+                frontier.push_back(next);
+            }
+        }
+        if (frontier.empty())
+            break;
+
+        /* take a random frontier cell out with an O(1) swap-remove */
+        int k = rand_num.bounded((uint32_t) frontier.size());
+        cur = frontier[k];
+        frontier[k] = frontier.back();
+        frontier.pop_back();
+
+        /* connect it to a random neighbour that is already in the maze */
+        int n = neighbours_in(walls, cur, state, 2, offs);
+        walls.carve(cur, offs[rand_num.bounded(n)]);
+    }
+}
+
+/* recursive backtracker, with an explicit stack instead of recursion */
+template <class walls_type>
+void generate_backtracker(walls_type &walls, rng_t &rand_num) {
+    int maze_size = walls.width * walls.height;
+    std::vector<char> visited(maze_size, 0);
+    std::vector<int> stack;
+    int offs[4];
+
+    stack.push_back(rand_num.bounded(maze_size));
+    visited[stack.back()] = 1;
+    while (!stack.empty()) {
+        int cur = stack.back();
+        int n = neighbours_in(walls, cur, visited, 0, offs);
+        if (n == 0) {
+            stack.pop_back();
+            continue;
+        }
+        int around = offs[rand_num.bounded(n)];
+        int next = walls.neighbour(cur, around);
+        walls.carve(cur, around);
+        visited[next] = 1;
+        stack.push_back(next);
+    }
+}
+
+/* the root of i, halving the path to it; also used by eller.cpp */
+inline int find_set(std::vector<int> &parent, int i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+/* Kruskal: knock down walls in random order unless both sides are already joined */
+template <class walls_type>
+void generate_kruskal(walls_type &walls, rng_t &rand_num) {
+    int maze_size = walls.width * walls.height;
+    std::vector<int> edges;                  //cell * 2 + 0 for its right wall, + 1 for its up wall
+    edges.reserve(maze_size * 2);
+    for (int cell = 0; cell < maze_size; ++cell) {
+        if (cell % walls.width < walls.width - 1)
+            edges.push_back(cell * 2);
+        if (cell / walls.width < walls.height - 1)
+            edges.push_back(cell * 2 + 1);
+    }
+    for (int i = (int) edges.size() - 1; i > 0; --i)
+        std::swap(edges[i], edges[rand_num.bounded(i + 1)]);
+
+    std::vector<int> parent(maze_size);
+    for (int i = 0; i < maze_size; ++i)
+        parent[i] = i;
+    for (int edge : edges) {
+        int cell = edge / 2;
+        int dir = (edge & 1) ? DIR_UP : DIR_RIGHT;
+        int a = find_set(parent, cell);
+        int b = find_set(parent, walls.neighbour(cell, dir));
+        if (a != b) {
+            parent[b] = a;
+            walls.carve(cell, dir);
+        }
+    }
+}
+
+/* Wilson: loop-erased random walks from every cell not in the maze yet,
+ * only the last exit taken from each cell is remembered */
+template <class walls_type>
+void generate_wilson(walls_type &walls, rng_t &rand_num) {
+    int maze_size = walls.width * walls.height;
+    std::vector<char> in_maze(maze_size, 0);
+    std::vector<char> exit_dir(maze_size, 0);
+
+    in_maze[rand_num.bounded(maze_size)] = 1;
+    for (int start = 0; start < maze_size; ++start) {
+        if (in_maze[start])
+            continue;
+        /* walk until the maze is hit */
+        int cur = start;
+        while (!in_maze[cur]) {
+            int around, next;
+            do {
+                around = rand_num.bounded(4);
+                next = walls.neighbour(cur, around);
+            } while (next < 0);
+            exit_dir[cur] = (char) around;
+            cur = next;
+        }
+        /* carve the walk with its loops erased */
+        for (cur = start; !in_maze[cur]; cur = walls.neighbour(cur, exit_dir[cur])) {
+            in_maze[cur] = 1;
+            walls.carve(cur, exit_dir[cur]);
+        }
+    }
+}
+
+/* binary tree: every cell opens either up or to the right */
+template <class walls_type>
+void generate_binary_tree(walls_type &walls, rng_t &rand_num) {
+    for (int y = 0; y < walls.height; ++y) {
+        for (int x = 0; x < walls.width; ++x) {
+            int cell = y * walls.width + x;
+            bool can_up = y < walls.height - 1;
+            bool can_right = x < walls.width - 1;
+            if (can_up && (!can_right || rand_num.coin()))
+                walls.carve(cell, DIR_UP);
+            else if (can_right)
+                walls.carve(cell, DIR_RIGHT);
+        }
+    }
+}
+
+/* sidewinder: runs along a row, each run opens up once at a random cell */
+template <class walls_type>
+void generate_sidewinder(walls_type &walls, rng_t &rand_num) {
+    for (int y = 0; y < walls.height; ++y) {
+        int run_start = 0;
+        for (int x = 0; x < walls.width; ++x) {
+            int cell = y * walls.width + x;
+            bool top = y == walls.height - 1;
+            bool close = x == walls.width - 1 || (!top && rand_num.coin());
+            if (!close) {
+                walls.carve(cell, DIR_RIGHT);
+            } else {
+                if (!top)
+                    walls.carve(y * walls.width + run_start + rand_num.bounded(x - run_start + 1), DIR_UP);
+                run_start = x + 1;
+            }
+        }
+    }
+}
+
+/* growing tree: grow from the newest active cell half of the time and from
+ * a random one otherwise, which mixes backtracker and Prim textures */
+template <class walls_type>
+void generate_growing_tree(walls_type &walls, rng_t &rand_num) {
+    int maze_size = walls.width * walls.height;
+    std::vector<char> visited(maze_size, 0);
+    std::vector<int> active;
+    int offs[4];
+
+    active.push_back(rand_num.bounded(maze_size));
+    visited[active.back()] = 1;
+    while (!active.empty()) {
+        int k = rand_num.coin() ? (int) active.size() - 1 : (int) rand_num.bounded((uint32_t) active.size());
+        int cur = active[k];
+        int n = neighbours_in(walls, cur, visited, 0, offs);
+        if (n == 0) {
+            active[k] = active.back();
+            active.pop_back();
+            continue;
+        }
+        int around = offs[rand_num.bounded(n)];
+        int next = walls.neighbour(cur, around);
+        walls.carve(cur, around);
+        visited[next] = 1;
+        active.push_back(next);
+    }
+}
+
+template <class walls_type>
+void store_eller_row(const maze_row_t *row, void *userdata) {
+    ((walls_type *) userdata)->store_row(row->y, row->right, row->up);
+}
+
+/* the seed of eller_generate() for a maze generated from rand_num, so that a
+ * maze streamed row by row is the same as one generated into a wallmap */
+inline uint64_t eller_seed(rng_t &rand_num) {
+    uint64_t high = rand_num();
+    return (high << 32) | rand_num();
+}
+
+/* Eller, with its rows stored into the wallmap */
+template <class walls_type>
+void generate_eller(walls_type &walls, rng_t &rand_num) {
+    uint64_t seed = eller_seed(rand_num);
+    eller_generate(walls.width, walls.height, seed, store_eller_row<walls_type>, &walls);
+}
+
+/* every generator by the name of its generate_<name>, in the order of
+ * generator_list; generator_list and generator_generate() are both made
+ * from it, so they can not disagree */
+#define GENERATOR_LIST(X) \
+        X(prim) X(backtracker) X(kruskal) X(wilson) X(binary_tree) X(sidewinder) X(growing_tree) X(eller)
+
+/* runs generator_list[index] on walls */
+template <class walls_type>
+void generator_generate(int index, walls_type &walls, rng_t &rand_num) {
+#define GENERATOR_FUNCTION(name) generate_##name<walls_type>,
+    static void (*const generate[])(walls_type &, rng_t &) = {GENERATOR_LIST(GENERATOR_FUNCTION)};
+#undef GENERATOR_FUNCTION
+    assert(index >= 0 && index < (int) (sizeof(generate) / sizeof(generate[0])));
+    generate[index](walls, rand_num);
+}
+
+/* generator_run() for any wall storage: generator from seed on walls, timed */
+template <class walls_type>
+generator_stats_t generator_run_walls(const generator_t *generator, walls_type &walls, uint64_t seed) {
+    generator_stats_t stats;
+    rng_t rand_num(seed);
+
+    assert(generator != NULL);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    walls.fill(1);
+    generator_generate((int) (generator - generator_list), walls, rand_num);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    stats.seconds = elapsed.count();
+    stats.cells_per_second = stats.seconds > 0 ? walls.width * (double) walls.height / stats.seconds : 0;
+    return stats;
+}
+
+#endif
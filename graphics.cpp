@@ -9,11 +9,16 @@
 
 #include <iostream>
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
 using namespace std;
 
 /* framebuffer management */
 
-framebuffer_t *framebuffer_create(int width, int height)
+framebuffer_t *framebuffer_create(int width, int height, framebuffer_format_t format)
 {
     vec4_t default_color = {0, 0, 0, 1};
     int num_elems = width * height;
@@ -24,7 +29,14 @@ framebuffer_t *framebuffer_create(int width, int height)
     framebuffer = (framebuffer_t*)malloc(sizeof(framebuffer_t));
     framebuffer->width = width;
     framebuffer->height = height;
-    framebuffer->colorbuffer = (vec4_t*)malloc(sizeof(vec4_t) * num_elems);
+    framebuffer->format = format;
+    framebuffer->colorbuffer = NULL;
+    framebuffer->packedbuffer = NULL;
+    framebuffer->dirty_count = 0;
+    if (format == FRAMEBUFFER_BGRA8)
+        framebuffer->packedbuffer = (uint32_t*)malloc(sizeof(uint32_t) * num_elems);
+    else
+        framebuffer->colorbuffer = (vec4_t*)malloc(sizeof(vec4_t) * num_elems);
 
     framebuffer_clear_color(framebuffer, default_color);
 
@@ -34,12 +46,92 @@ framebuffer_t *framebuffer_create(int width, int height)
 void framebuffer_release(framebuffer_t *framebuffer)
 {
     free(framebuffer->colorbuffer);
+    free(framebuffer->packedbuffer);
     free(framebuffer);
 }
 
+static long long rect_area(ivec4_t rect)
+{
+    return (long long) (rect.y - rect.x + 1) * (rect.w - rect.z + 1);
+}
+
+static ivec4_t rect_union(ivec4_t a, ivec4_t b)
+{
+    return ivec4_new(min(a.x, b.x), max(a.y, b.y), min(a.z, b.z), max(a.w, b.w));
+}
+
+/* true if a and b overlap or touch */
+static bool rect_meet(ivec4_t a, ivec4_t b)
+{
+    return a.x <= b.y + 1 && b.x <= a.y + 1 && a.z <= b.w + 1 && b.z <= a.w + 1;
+}
+
+void framebuffer_mark_dirty(framebuffer_t *framebuffer, ivec4_t range)
+{
+    range.x = max(range.x, 0);
+    range.y = min(range.y, framebuffer->width - 1);
+    range.z = max(range.z, 0);
+    range.w = min(range.w, framebuffer->height - 1);
+    if (range.x > range.y || range.z > range.w)
+        return;
+
+    ivec4_t *dirty = framebuffer->dirty;
+    int &count = framebuffer->dirty_count;
+    for (int i = 0; i < count; i++)
+        if (dirty[i].x <= range.x && range.y <= dirty[i].y && dirty[i].z <= range.z && range.w <= dirty[i].w)
+            return;
+
+    /* grow a rectangle the new one meets, which may then meet others */
+    int into = -1;
+    for (int i = 0; i < count; i++)
+        if (rect_meet(dirty[i], range)) {
+            into = i;
+            break;
+        }
+    if (into < 0 && count < FRAMEBUFFER_DIRTY_MAX) {
+        dirty[count++] = range;
+        return;
+    }
+    if (into < 0) {
+        /* full: into the one that grows least */
+        long long best = -1;
+        for (int i = 0; i < count; i++) {
+            long long growth = rect_area(rect_union(dirty[i], range)) - rect_area(dirty[i]);
+            if (best < 0 || growth < best) {
+                best = growth;
+                into = i;
+            }
+        }
+    }
+    dirty[into] = rect_union(dirty[into], range);
+    for (int i = 0; i < count; i++) {
+        if (i == into || !rect_meet(dirty[i], dirty[into]))
+            continue;
+        dirty[into] = rect_union(dirty[into], dirty[i]);
+        dirty[i] = dirty[--count];
+        if (into == count)
+            into = i;
+        i = -1;
+    }
+}
+
+void framebuffer_clear_dirty(framebuffer_t *framebuffer)
+{
+    framebuffer->dirty_count = 0;
+}
+
 void framebuffer_clear_color(framebuffer_t *framebuffer, vec4_t color)
 {
     int num_elems = framebuffer->width * framebuffer->height;
+    framebuffer->dirty_count = 0;
+    framebuffer_mark_dirty(framebuffer, ivec4_new(0, framebuffer->width - 1, 0, framebuffer->height - 1));
+    if (framebuffer->format == FRAMEBUFFER_BGRA8) {
+        uint32_t packed = raster_pack(color);
+        uint32_t *pixels = framebuffer->packedbuffer;
+        for (int i = 0; i < num_elems; ++i)
+            pixels[i] = packed;
+        return;
+    }
     for (int i = 0; i < num_elems; ++i) {
         framebuffer->colorbuffer[i] = color;
     }
@@ -47,14 +139,27 @@ void framebuffer_clear_color(framebuffer_t *framebuffer, vec4_t color)
 
 void framebuffer_copy(framebuffer_t *a, const framebuffer_t *b, ivec4_t range)
 {
-    for (int y = range.z; y <= range.w; y++)
-        for (int x = range.x; x <= range.y; x++)
-            a->colorbuffer[x + y * WINDOW_WIDTH] = b->colorbuffer[x + y * WINDOW_WIDTH];
+    assert(a->format == b->format);
+    if (range.y < range.x)
+        return;
+    framebuffer_mark_dirty(a, range);
+    for (int y = range.z; y <= range.w; y++) {
+        int first = range.x + y * a->width;
+        if (a->format == FRAMEBUFFER_BGRA8)
+            memcpy(a->packedbuffer + first, b->packedbuffer + first, sizeof(uint32_t) * (range.y - range.x + 1));
+        else
+            memcpy(a->colorbuffer + first, b->colorbuffer + first, sizeof(vec4_t) * (range.y - range.x + 1));
+    }
 }
 
 void set_pixel(framebuffer_t *framebuffer, int x, int y, float r, float g, float b)
 {
     int iter = x + (y - 1) * framebuffer->width;
+    framebuffer_mark_dirty(framebuffer, ivec4_new(x, x, y - 1, y - 1));
+    if (framebuffer->format == FRAMEBUFFER_BGRA8) {
+        framebuffer->packedbuffer[iter] = raster_pack(vec4_new(r, g, b, 1));
+        return;
+    }
     framebuffer->colorbuffer[iter].x = r;
     framebuffer->colorbuffer[iter].y = g;
     framebuffer->colorbuffer[iter].z = b;
@@ -69,6 +174,15 @@ void set_pixel(framebuffer_t *framebuffer, int x, int y, vec3_t color)
 void alpha_blend(framebuffer_t *framebuffer, int x, int y, float alpha, float r, float g, float b)
 {
     int iter = x + (y - 1) * framebuffer->width;
+    framebuffer_mark_dirty(framebuffer, ivec4_new(x, x, y - 1, y - 1));
+    if (framebuffer->format == FRAMEBUFFER_BGRA8) {
+        vec4_t color = raster_unpack(framebuffer->packedbuffer[iter]);
+        color.x = color.x * (1 - alpha) + r * alpha;
+        color.y = color.y * (1 - alpha) + g * alpha;
+        color.z = color.z * (1 - alpha) + b * alpha;
+        framebuffer->packedbuffer[iter] = raster_pack(color);
+        return;
+    }
     vec4_t *colorbuffer = framebuffer->colorbuffer + iter;
     colorbuffer->x = colorbuffer->x * (1 - alpha) + r * alpha;
     colorbuffer->y = colorbuffer->y * (1 - alpha) + g * alpha;
@@ -79,6 +193,56 @@ void alpha_blend(framebuffer_t *framebuffer, int x, int y, float alpha, float r,
 
 /* graphics drawing */
 
+/* the row kernels of the shapes below, see raster.h */
+static const raster_t *raster = raster_best();
+
+void graphics_set_raster(const raster_t *kernels)
+{
+    raster = kernels ? kernels : raster_best();
+}
+
+/* runs the kernels of one shape over the pixels AABB.x..AABB.y of rows
+ * AABB.z..AABB.w that lie in y0..y1 */
+template <class shape_t>
+static void raster_rows(ivec4_t AABB, int y0, int y1,
+                        void (*kernel)(vec4_t *, int, int, float, const shape_t *, vec3_t),
+                        void (*kernel_packed)(uint32_t *, int, int, float, const shape_t *, vec3_t),
+                        const shape_t *shape, vec3_t color)
+{
+    for (int y = max(AABB.z, y0); y <= min(AABB.w, y1); y++) {
+        int first = (y - 1) * framebuffer->width;
+        if (framebuffer->format == FRAMEBUFFER_BGRA8)
+            kernel_packed(framebuffer->packedbuffer + first, AABB.x, AABB.y, y, shape, color);
+        else
+            kernel(framebuffer->colorbuffer + first, AABB.x, AABB.y, y, shape, color);
+    }
+}
+
+/* one draw_* call, over the pixels AABB.x..AABB.y of rows AABB.z..AABB.w;
+ * drawn right away, or recorded in a batch */
+struct box_tile;
+
+typedef enum {COMMAND_BOX, COMMAND_CIRCLE, COMMAND_CAPSULE, COMMAND_TILE} command_kind_t;
+
+typedef struct {
+    command_kind_t kind;
+    ivec4_t AABB;
+    vec3_t color;
+    union {
+        raster_box_t box;
+        raster_circle_t circle;
+        raster_capsule_t capsule;
+        struct {
+            const struct box_tile *tile;
+            int left, bottom;           //pixel of the first tile pixel
+        } cached;
+    };
+} command_t;
+
+static void submit(const command_t &command);
+
+static void batch_flush(void);
+
 void setpixel(int x, int y, float r, float g, float b)
 {
     set_pixel(framebuffer, x, y, r, g, b);
@@ -114,10 +278,12 @@ ivec4_t capsuleAABB(float ax, float ay, float bx, float by, float r)
 
 void draw_line(float ax, float ay, float bx, float by, float r, vec3_t color)
 {
-    ivec4_t AABB = capsuleAABB(ax, ay, bx, by, r);
-    for (int y = AABB.z; y <= AABB.w; y++)
-        for (int x = AABB.x; x <= AABB.y; x++)
-            alphablend(x, y, fmaxf(fminf(0.5f - capsuleSDF(x, y, ax, ay, bx, by, r), 1.0f), 0.0f), color.x, color.y, color.z);
+    command_t command;
+    command.kind = COMMAND_CAPSULE;
+    command.AABB = capsuleAABB(ax, ay, bx, by, r);
+    command.color = color;
+    command.capsule = {ax, ay, bx, by, r};
+    submit(command);
 }
 
 //CIRCLE
@@ -138,10 +304,12 @@ ivec4_t circleAABB(float cx, float cy, float r)
 
 void draw_circle(float cx, float cy, float r, vec3_t color)
 {
-    ivec4_t AABB = circleAABB(cx, cy, r);
-    for (int y = AABB.z; y <= AABB.w; y++)
-        for (int x = AABB.x; x <= AABB.y; x++)
-            alphablend(x, y, fmaxf(fminf(0.5f - circleSDF(x, y, cx, cy, r), 1.0f), 0.0f), color.x, color.y, color.z);
+    command_t command;
+    command.kind = COMMAND_CIRCLE;
+    command.AABB = circleAABB(cx, cy, r);
+    command.color = color;
+    command.circle = {cx, cy, r};
+    submit(command);
 }
 
 //BOX
@@ -169,18 +337,325 @@ ivec4_t boxAABB(float cx, float cy, float theta, float w, float h)
 }
 void draw_box(float cx, float cy, float theta, float w, float h, vec3_t color)
 {
-    ivec4_t AABB = boxAABB(cx, cy, theta, w, h);
-    for (int y = AABB.z; y <= AABB.w; y++)
-        for (int x = AABB.x; x <= AABB.y; x++)
-            alphablend(x, y, fmaxf(fminf(0.5f - boxSDF(x, y, cx, cy, theta, w, h), 1.0f), 0.0f), color.x, color.y, color.z);
+    command_t command;
+    command.kind = COMMAND_BOX;
+    command.AABB = boxAABB(cx, cy, theta, w, h);
+    command.color = color;
+    command.box = {cx, cy, cosf(theta), sinf(theta), w * 0.5f, h * 0.5f, 0};
+    submit(command);
 }
 
 void draw_filleted_box(float cx, float cy, float theta, float w, float h, float r, vec3_t color)
 {
-    ivec4_t AABB = boxAABB(cx, cy, theta, w, h);
+    command_t command;
+    command.kind = COMMAND_BOX;
+    command.AABB = boxAABB(cx, cy, theta, w, h);
+    command.color = color;
     w -= r * 2.0;
     h -= r * 2.0;
-    for (int y = AABB.z; y <= AABB.w; y++)
-        for (int x = AABB.x; x <= AABB.y; x++)
-            alphablend(x, y, fmaxf(fminf(0.5f - boxSDF(x, y, cx, cy, theta, w, h) + r, 1.0f), 0.0f), color.x, color.y, color.z);
+    command.box = {cx, cy, cosf(theta), sinf(theta), w * 0.5f, h * 0.5f, r};
+    submit(command);
+}
+
+//TILE CACHE
+typedef struct box_tile {
+    bool ready;
+    int x0, y0;                         //first pixel, relative to the pixel of the centre
+    int width, height;
+    std::vector<float> coverage;        //width * height
+    std::vector<int> span_begin;        //per row, the pixels with any coverage
+    std::vector<int> span_end;
+} box_tile_t;
+
+struct tile_cache {
+    float w, h, r;
+    box_tile_t tiles[TILE_PHASES * TILE_PHASES];
+};
+
+tile_cache_t *tile_cache_update(tile_cache_t *cache, float w, float h, float r)
+{
+    if (cache && cache->w == w && cache->h == h && cache->r == r)
+        return cache;
+    if (cache)
+        tile_cache_release(cache);
+    cache = new tile_cache_t;
+    cache->w = w;
+    cache->h = h;
+    cache->r = r;
+    for (box_tile_t &tile : cache->tiles)
+        tile.ready = false;
+    return cache;
+}
+
+void tile_cache_release(tile_cache_t *cache)
+{
+    /* boxes recorded in a batch point into the cache */
+    batch_flush();
+    delete cache;
+}
+
+/* the box centred at (fx, fy) of the pixel grid, over the same pixels as boxAABB */
+static void build_tile(box_tile_t &tile, float fx, float fy, float w, float h, float r)
+{
+    tile.x0 = (int)floorf(fx - w * 0.5f) - 1;
+    tile.y0 = (int)floorf(fy - h * 0.5f) - 1;
+    tile.width = (int) ceilf(fx + w * 0.5f) + 1 - tile.x0 + 1;
+    tile.height = (int) ceilf(fy + h * 0.5f) + 1 - tile.y0 + 1;
+    tile.coverage.assign(tile.width * tile.height, 0.0f);
+    tile.span_begin.assign(tile.height, 0);
+    tile.span_end.assign(tile.height, 0);
+    for (int y = 0; y < tile.height; y++) {
+        float *row = &tile.coverage[y * tile.width];
+        int begin = tile.width, end = 0;
+        for (int x = 0; x < tile.width; x++) {
+            float sdf = boxSDF(tile.x0 + x, tile.y0 + y, fx, fy, 0, w - r * 2.0f, h - r * 2.0f);
+            row[x] = fmaxf(fminf(0.5f - sdf + r, 1.0f), 0.0f);
+            if (row[x] > 0) {
+                begin = min(begin, x);
+                end = x + 1;
+            }
+        }
+        tile.span_begin[y] = begin;
+        tile.span_end[y] = max(begin, end);
+    }
+    tile.ready = true;
+}
+
+/* the pixel of v and its phase, carried into the next pixel when it rounds up */
+static void split_phase(float v, int &pixel, int &phase)
+{
+    pixel = (int)floorf(v);
+    phase = (int)lroundf((v - pixel) * TILE_PHASES);
+    if (phase == TILE_PHASES) {
+        ++pixel;
+        phase = 0;
+    }
+}
+
+void draw_filleted_box_cached(tile_cache_t *cache, float cx, float cy, vec3_t color)
+{
+    int px, py, phase_x, phase_y;
+    split_phase(cx, px, phase_x);
+    split_phase(cy, py, phase_y);
+    box_tile_t &tile = cache->tiles[phase_y * TILE_PHASES + phase_x];
+    if (!tile.ready)
+        build_tile(tile, (float) phase_x / TILE_PHASES, (float) phase_y / TILE_PHASES, cache->w, cache->h, cache->r);
+
+    command_t command;
+    command.kind = COMMAND_TILE;
+    command.cached.tile = &tile;
+    command.cached.left = px + tile.x0;
+    command.cached.bottom = py + tile.y0;
+    command.AABB = ivec4_new(command.cached.left, command.cached.left + tile.width - 1, command.cached.bottom,
+                             command.cached.bottom + tile.height - 1);
+    command.color = color;
+    submit(command);
+}
+
+/* the rows y0..y1 of a box drawn with its tile */
+static void blend_tile_rows(const box_tile_t &tile, int left, int bottom, vec3_t color, int y0, int y1)
+{
+    y0 = max(bottom, y0);
+    y1 = min(bottom + tile.height - 1, y1);
+    uint32_t packed = raster_pack(vec4_new(color.x, color.y, color.z, 1));
+    for (int y = y0; y <= y1; y++) {
+        int row = y - bottom;
+        int x0 = max(left + tile.span_begin[row], 0);
+        int x1 = min(left + tile.span_end[row], WINDOW_WIDTH);
+        const float *coverage = &tile.coverage[row * tile.width] - left;
+        if (framebuffer->format == FRAMEBUFFER_BGRA8) {
+            uint32_t *out = framebuffer->packedbuffer + (y - 1) * framebuffer->width;
+            for (int x = x0; x < x1; x++) {
+                float alpha = coverage[x];
+                if (alpha == 1.0f) {
+                    out[x] = (out[x] & 0xff000000u) | (packed & 0xffffffu);
+                } else {
+                    vec4_t pixel = raster_unpack(out[x]);
+                    pixel.x = pixel.x * (1 - alpha) + color.x * alpha;
+                    pixel.y = pixel.y * (1 - alpha) + color.y * alpha;
+                    pixel.z = pixel.z * (1 - alpha) + color.z * alpha;
+                    out[x] = raster_pack(pixel);
+                }
+            }
+            continue;
+        }
+        vec4_t *out = framebuffer->colorbuffer + (y - 1) * framebuffer->width;
+        for (int x = x0; x < x1; x++) {
+            float alpha = coverage[x];
+            if (alpha == 1.0f) {
+                out[x].x = color.x;
+                out[x].y = color.y;
+                out[x].z = color.z;
+            } else {
+                out[x].x = out[x].x * (1 - alpha) + color.x * alpha;
+                out[x].y = out[x].y * (1 - alpha) + color.y * alpha;
+                out[x].z = out[x].z * (1 - alpha) + color.z * alpha;
+            }
+        }
+    }
+}
+
+//BATCH
+/* rows of the framebuffer per task; a band spans the whole width, so every
+ * row of a shape is drawn over the same pixels as without a batch, which is
+ * what keeps the vector kernels to the same results */
+#define BATCH_BAND 32
+
+static bool batching = false;
+static int batch_threads = 0;           //0 for one per core
+static vector<command_t> commands;
+static vector<vector<int> > bands;      //per band, the commands over it in order
+
+/* the rows y0..y1 of command. alphablend() puts pixel (x, y) on row y - 1,
+ * so row 0 has nowhere to go */
+static void draw_command_rows(const command_t &command, int y0, int y1)
+{
+    y0 = max(y0, 1);
+    y1 = min(y1, WINDOW_HEIGHT - 1);
+    switch (command.kind) {
+    case COMMAND_BOX:
+        raster_rows(command.AABB, y0, y1, raster->box, raster->box_packed, &command.box, command.color);
+        break;
+    case COMMAND_CIRCLE:
+        raster_rows(command.AABB, y0, y1, raster->circle, raster->circle_packed, &command.circle, command.color);
+        break;
+    case COMMAND_CAPSULE:
+        raster_rows(command.AABB, y0, y1, raster->capsule, raster->capsule_packed, &command.capsule, command.color);
+        break;
+    case COMMAND_TILE:
+        blend_tile_rows(*command.cached.tile, command.cached.left, command.cached.bottom, command.color, y0, y1);
+        break;
+    }
+}
+
+static void submit(const command_t &command)
+{
+    const ivec4_t &AABB = command.AABB;
+    framebuffer_mark_dirty(framebuffer, ivec4_new(AABB.x, AABB.y, AABB.z - 1, AABB.w - 1));
+    if (!batching) {
+        draw_command_rows(command, AABB.z, AABB.w);
+        return;
+    }
+    int first = max(AABB.z, 1), last = min(AABB.w, WINDOW_HEIGHT - 1);
+    if (first > last)
+        return;
+    commands.push_back(command);
+    for (int band = (first - 1) / BATCH_BAND; band <= (last - 1) / BATCH_BAND; band++)
+        bands[band].push_back((int) commands.size() - 1);
+}
+
+static void draw_bands(atomic<int> *next)
+{
+    for (int band = (*next)++; band < (int) bands.size(); band = (*next)++)
+        for (int i : bands[band])
+            draw_command_rows(commands[i], band * BATCH_BAND + 1, (band + 1) * BATCH_BAND);
+}
+
+/* the threads that draw batches with the caller of batch_flush(): started
+ * by the first batch, they wait between flushes and are joined when the
+ * thread count changes or the program ends */
+typedef struct batch_pool {
+    mutex lock;
+    condition_variable wake;            //a flush began, or stopping
+    condition_variable done;            //running came down to 0
+    vector<thread> threads;
+    atomic<int> next;                   //the next band to draw
+    int generation = 0;                 //flushes so far
+    int running = 0;                    //threads still on this flush
+    bool stopping = false;
+
+    ~batch_pool();
+} batch_pool_t;
+
+static batch_pool_t pool;
+
+static void pool_run(void)
+{
+    int seen = 0;
+    for (;;) {
+        {
+            unique_lock<mutex> guard(pool.lock);
+            pool.wake.wait(guard, [&] { return pool.stopping || pool.generation != seen; });
+            if (pool.stopping)
+                return;
+            seen = pool.generation;
+        }
+        draw_bands(&pool.next);
+        lock_guard<mutex> guard(pool.lock);
+        if (--pool.running == 0)
+            pool.done.notify_one();
+    }
+}
+
+static void pool_stop(void)
+{
+    {
+        lock_guard<mutex> guard(pool.lock);
+        pool.stopping = true;
+    }
+    pool.wake.notify_all();
+    for (thread &worker : pool.threads)
+        worker.join();
+    pool.threads.clear();
+    pool.stopping = false;
+}
+
+batch_pool::~batch_pool()
+{
+    pool_stop();
+}
+
+/* threads - 1 workers in the pool, the caller of batch_flush() being the last */
+static void pool_resize(int threads)
+{
+    if ((int) pool.threads.size() == threads - 1)
+        return;
+    pool_stop();
+    for (int i = 1; i < threads; i++)
+        pool.threads.push_back(thread(pool_run));
+}
+
+/* draws what has been recorded so far, the batch going on */
+static void batch_flush(void)
+{
+    if (!batching || commands.empty())
+        return;
+    pool.next = 0;
+    if (!pool.threads.empty()) {
+        {
+            lock_guard<mutex> guard(pool.lock);
+            pool.running = (int) pool.threads.size();
+            ++pool.generation;
+        }
+        pool.wake.notify_all();
+    }
+    draw_bands(&pool.next);
+    if (!pool.threads.empty()) {
+        unique_lock<mutex> guard(pool.lock);
+        pool.done.wait(guard, [] { return pool.running == 0; });
+    }
+    commands.clear();
+    for (vector<int> &band : bands)
+        band.clear();
+}
+
+void graphics_set_threads(int threads)
+{
+    batch_threads = max(threads, 0);
+}
+
+void graphics_begin_batch(void)
+{
+    assert(!batching);
+    batching = true;
+    bands.resize((WINDOW_HEIGHT - 2) / BATCH_BAND + 1);
+    int threads = batch_threads > 0 ? batch_threads : max(1, (int) thread::hardware_concurrency());
+    pool_resize(min(threads, (int) bands.size()));
+}
+
+void graphics_end_batch(void)
+{
+    assert(batching);
+    batch_flush();
+    batching = false;
 }
@@ -1,16 +1,35 @@
 #ifndef GRAPHICS_H
 #define GRAPHICS_H
 
+#include <stdint.h>
+
 #include "maths.h"
+#include "raster.h"
+
+/* FRAMEBUFFER_FLOAT keeps a vec4_t per pixel; FRAMEBUFFER_BGRA8 keeps 4
+ * bytes, a quarter of the memory, in the layout of a 32-bit windows DIB
+ * (blue in the low byte), so presenting it is a copy. channels are clamped
+ * to [0, 1] and rounded to 1/255 whenever a pixel is written, see
+ * raster_pack() */
+typedef enum {FRAMEBUFFER_FLOAT, FRAMEBUFFER_BGRA8} framebuffer_format_t;
+
+/* the pixels changed since the buffer was last presented are kept as up to
+ * FRAMEBUFFER_DIRTY_MAX rectangles, merged as they come in; each is the
+ * inclusive x0, x1, y0, y1 of buffer rows, like the range of framebuffer_copy */
+#define FRAMEBUFFER_DIRTY_MAX 16
 
 typedef struct {
     int width, height;
-    vec4_t *colorbuffer;
+    framebuffer_format_t format;
+    vec4_t *colorbuffer;                //FRAMEBUFFER_FLOAT, else NULL
+    uint32_t *packedbuffer;             //FRAMEBUFFER_BGRA8, else NULL
+    int dirty_count;
+    ivec4_t dirty[FRAMEBUFFER_DIRTY_MAX];
 } framebuffer_t;
 
 
 /* framebuffer management */
-framebuffer_t *framebuffer_create(int width, int height);
+framebuffer_t *framebuffer_create(int width, int height, framebuffer_format_t format = FRAMEBUFFER_FLOAT);
 
 void framebuffer_release(framebuffer_t *framebuffer);
 
@@ -18,6 +37,12 @@ void framebuffer_clear_color(framebuffer_t *framebuffer, vec4_t color);
 
 void framebuffer_copy(framebuffer_t *a, const framebuffer_t *b, ivec4_t range);
 
+/* every function here that writes pixels marks them; window_draw_buffer()
+ * presents the dirty rectangles and clears them */
+void framebuffer_mark_dirty(framebuffer_t *framebuffer, ivec4_t range);
+
+void framebuffer_clear_dirty(framebuffer_t *framebuffer);
+
 void set_pixel(framebuffer_t *framebuffer, int x, int y, float r, float g, float b);
 
 void set_pixel(framebuffer_t *framebuffer, int x, int y, vec3_t color);
@@ -25,6 +50,11 @@ void set_pixel(framebuffer_t *framebuffer, int x, int y, vec3_t color);
 void alpha_blend(framebuffer_t *framebuffer, int x, int y, float alpha, float r, float g, float b);
 
 /* graphics drawing*/
+
+/* kernels for draw_line, draw_circle, draw_box and draw_filleted_box;
+ * NULL picks raster_best(), which is also the default */
+void graphics_set_raster(const raster_t *kernels);
+
 void setpixel(int x, int y, float r, float g, float b);
 
 void setpixel(int x, int y, vec3_t color);
@@ -45,5 +75,39 @@ void draw_box(float cx, float cy, float theta, float w, float h, vec3_t color);
 
 void draw_filleted_box(float cx, float cy, float theta, float w, float h, float r, vec3_t color);
 
+/* tile cache for drawing many upright filleted boxes of one size
+ *
+ * the coverage of the box is rasterized once per sub-pixel phase of its
+ * centre, to 1 / TILE_PHASES of a pixel, on first use; drawing a box then
+ * blends that tile over the pixels span by span without evaluating boxSDF,
+ * and stores the color outright where the coverage is full. the result is
+ * that of draw_filleted_box(cx, cy, 0, w, h, r, color) with the centre
+ * rounded to the nearest phase.
+ */
+#define TILE_PHASES 16
+
+typedef struct tile_cache tile_cache_t;
+
+/* returns cache if it was made for w, h and r, else releases it (if not
+ * NULL) and returns a new one */
+tile_cache_t *tile_cache_update(tile_cache_t *cache, float w, float h, float r);
+
+void tile_cache_release(tile_cache_t *cache);
+
+void draw_filleted_box_cached(tile_cache_t *cache, float cx, float cy, vec3_t color);
+
+/* batches: between graphics_begin_batch() and graphics_end_batch(), the
+ * draw_* calls above are recorded and binned by their AABB into bands of
+ * rows; graphics_end_batch() draws the bands on threads, each the commands
+ * over it in order, which gives the pixels of drawing them one by one.
+ * nothing else may write to the framebuffer, or change it, in a batch */
+void graphics_begin_batch(void);
+
+void graphics_end_batch(void);
+
+/* threads to draw batches on, 0 (the default) for one per core; they are
+ * started by the next graphics_begin_batch() and kept between batches */
+void graphics_set_threads(int threads);
+
 
 #endif
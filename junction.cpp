@@ -0,0 +1,263 @@
+#include <cassert>
+#include <cstdlib>
+
+#include <algorithm>
+
+#include "junction.h"
+
+using namespace std;
+
+junction_graph_t::junction_graph_t() : expanded(0), width(0), height(0), reached_by(-1) {}
+
+/* follows the corridor leaving node through dir up to the next node and
+ * records it as an edge, unless it was recorded from its other end */
+int junction_graph_t::trace(const wallmap_t &walls, int node, int dir) {
+    int cell = node_cell[node];
+    int next = walls.neighbour(cell, dir);
+    if (edge_of[next] >= 0)
+        return -1;
+    if (node_of[next] >= 0 && node_of[next] < node)
+        return -1;
+
+    edge_t edge;
+    int id = (int) edges.size();
+    int prev = cell, cur = next, length = 1;
+    edge.a = node;
+    edge.first = (int) corridor_cells.size();
+    while (node_of[cur] < 0) {
+        edge_of[cur] = id;
+        offset_of[cur] = length;
+        corridor_cells.push_back(cur);
+        /* two ways out, one of them back */
+        int out = -1;
+        for (int d = 0; d < 4 && out < 0; ++d) {
+            if (!walls.wall(cur, d) && walls.neighbour(cur, d) != prev)
+                out = walls.neighbour(cur, d);
+        }
+        prev = cur;
+        cur = out;
+        ++length;
+    }
+    edge.b = node_of[cur];
+    edge.length = length;
+    edges.push_back(edge);
+    return id;
+}
+
+void junction_graph_t::build(const wallmap_t &walls) {
+    int maze_size = walls.width * walls.height;
+    width = walls.width;
+    height = walls.height;
+    node_of.assign(maze_size, -1);
+    edge_of.assign(maze_size, -1);
+    offset_of.assign(maze_size, 0);
+    node_cell.clear();
+    edges.clear();
+    corridor_cells.clear();
+
+    vector<char> ways(maze_size, 0);
+    for (int cell = 0; cell < maze_size; ++cell) {
+        for (int dir = 0; dir < 4; ++dir)
+            ways[cell] += !walls.wall(cell, dir);
+        if (ways[cell] != 2) {
+            node_of[cell] = (int) node_cell.size();
+            node_cell.push_back(cell);
+        }
+    }
+    for (int node = 0; node < (int) node_cell.size(); ++node)
+        for (int dir = 0; dir < 4; ++dir)
+            if (!walls.wall(node_cell[node], dir))
+                trace(walls, node, dir);
+    /* loops without any junction on them get one */
+    for (int cell = 0; cell < maze_size; ++cell) {
+        if (node_of[cell] >= 0 || edge_of[cell] >= 0)
+            continue;
+        node_of[cell] = (int) node_cell.size();
+        node_cell.push_back(cell);
+        for (int dir = 0; dir < 4; ++dir)
+            if (!walls.wall(cell, dir))
+                trace(walls, node_of[cell], dir);
+    }
+
+    int node_count = (int) node_cell.size();
+    adjacency_first.assign(node_count + 1, 0);
+    for (const edge_t &edge : edges) {
+        ++adjacency_first[edge.a + 1];
+        ++adjacency_first[edge.b + 1];
+    }
+    for (int node = 0; node < node_count; ++node)
+        adjacency_first[node + 1] += adjacency_first[node];
+    adjacency.assign(adjacency_first[node_count], 0);
+    vector<int> fill_at(adjacency_first.begin(), adjacency_first.end() - 1);
+    for (int id = 0; id < (int) edges.size(); ++id) {
+        adjacency[fill_at[edges[id].a]++] = id;
+        adjacency[fill_at[edges[id].b]++] = id;
+    }
+}
+
+int junction_graph_t::cell_at(int edge, int offset) const {
+    const edge_t &e = edges[edge];
+    if (offset == 0)
+        return node_cell[e.a];
+    if (offset == e.length)
+        return node_cell[e.b];
+    return corridor_cells[e.first + offset - 1];
+}
+
+void junction_graph_t::push(int at, int node, size_t &last) {
+    if ((size_t) at >= open.size())
+        open.resize(at + 1);
+    open[at].push_back(node);
+    last = max(last, (size_t) at + 1);
+}
+
+/* Dijkstra over the nodes with a bucket per cost, as corridor lengths are
+ * small integers; a cell on a corridor starts from, or is reached through,
+ * both ends of it */
+int junction_graph_t::search(int from, int to) {
+    int best = -1;
+
+    cost.assign(node_cell.size(), -1);
+    parent_edge.assign(node_cell.size(), -1);
+    expanded = 0;
+    reached_by = -1;
+
+    int from_node = node_of[from], to_node = node_of[to];
+    if (from == to)
+        return 0;
+    if (from_node < 0 && to_node < 0 && edge_of[from] == edge_of[to])
+        best = abs(offset_of[from] - offset_of[to]);
+
+    size_t last = 0;                    //one past the last bucket in use
+    if (from_node >= 0) {
+        cost[from_node] = 0;
+        push(0, from_node, last);
+    } else {
+        const edge_t &e = edges[edge_of[from]];
+        int ends[2] = {e.a, e.b}, costs[2] = {offset_of[from], e.length - offset_of[from]};
+        for (int i = 0; i < 2; ++i) {
+            if (cost[ends[i]] < 0 || costs[i] < cost[ends[i]]) {
+                cost[ends[i]] = costs[i];
+                push(costs[i], ends[i], last);
+            }
+        }
+    }
+
+    for (size_t at = 0; at < last && (best < 0 || (int) at < best); ++at) {
+        while (!open[at].empty()) {
+            int node = open[at].back();
+            open[at].pop_back();
+            if (cost[node] != (int) at)
+                continue;               //queued again since with a lower cost
+            ++expanded;
+
+            /* the rest of the way to the goal from this node, if it is an end of its corridor */
+            int rest = -1;
+            if (to_node >= 0) {
+                rest = node == to_node ? 0 : -1;
+            } else {
+                const edge_t &e = edges[edge_of[to]];
+                if (node == e.a)
+                    rest = offset_of[to];
+                if (node == e.b && (rest < 0 || e.length - offset_of[to] < rest))
+                    rest = e.length - offset_of[to];
+            }
+            if (rest >= 0 && (best < 0 || (int) at + rest < best)) {
+                best = (int) at + rest;
+                reached_by = node;
+            }
+
+            for (int k = adjacency_first[node]; k < adjacency_first[node + 1]; ++k) {
+                const edge_t &e = edges[adjacency[k]];
+                int other = e.a == node ? e.b : e.a;
+                int next_cost = (int) at + e.length;
+                if (cost[other] >= 0 && cost[other] <= next_cost)
+                    continue;
+                cost[other] = next_cost;
+                parent_edge[other] = adjacency[k];
+                push(next_cost, other, last);
+            }
+        }
+    }
+    for (size_t at = 0; at < last; ++at)
+        open[at].clear();
+    return best;
+}
+
+int junction_graph_t::distance(int from, int to) {
+    return search(from, to);
+}
+
+/* appends the cells of edge from offset first to offset last, without the
+ * one at first */
+static void walk_edge(int first, int last, vector<int> &offsets) {
+    int step = last > first ? 1 : -1;
+    for (int offset = first; offset != last;) {
+        offset += step;
+        offsets.push_back(offset);
+    }
+}
+
+int junction_graph_t::solve(int from, int to, vector<int> &path) {
+    path.clear();
+    int best = search(from, to);
+    if (best < 0)
+        return 0;
+
+    /* the cells from the goal back to the start */
+    vector<int> cells, offsets;
+    cells.push_back(to);
+    if (reached_by < 0) {
+        if (from != to) {
+            walk_edge(offset_of[to], offset_of[from], offsets);
+            for (int offset : offsets)
+                cells.push_back(cell_at(edge_of[from], offset));
+        }
+    } else {
+        int node = reached_by;
+        if (node_of[to] < 0) {
+            /* along the goal's corridor to the end it was reached by */
+            const edge_t &e = edges[edge_of[to]];
+            int end = node == e.a && offset_of[to] == best - cost[node] ? 0 : e.length;
+            walk_edge(offset_of[to], end, offsets);
+            for (int offset : offsets)
+                cells.push_back(cell_at(edge_of[to], offset));
+        }
+        while (parent_edge[node] >= 0) {
+            int id = parent_edge[node];
+            const edge_t &e = edges[id];
+            int other = e.a == node ? e.b : e.a;
+            offsets.clear();
+            walk_edge(e.a == node ? 0 : e.length, e.a == node ? e.length : 0, offsets);
+            for (int offset : offsets)
+                cells.push_back(cell_at(id, offset));
+            node = other;
+        }
+        if (node_of[from] < 0) {
+            /* along the start's corridor from the end the search began at */
+            const edge_t &e = edges[edge_of[from]];
+            int end = node == e.a && offset_of[from] == cost[node] ? 0 : e.length;
+            offsets.clear();
+            walk_edge(end, offset_of[from], offsets);
+            for (int offset : offsets)
+                cells.push_back(cell_at(edge_of[from], offset));
+        }
+    }
+    reverse(cells.begin(), cells.end());
+
+    /* a gap is halfway between two cells */
+    int rmw = width * 2 + 1;
+    path.reserve(cells.size() * 2 - 1);
+    for (size_t i = 0; i < cells.size(); ++i) {
+        int at = (cells[i] / width * 2 + 1) * rmw + cells[i] % width * 2 + 1;
+        if (i > 0)
+            path.push_back((path.back() + at) / 2);
+        path.push_back(at);
+    }
+    return 1;
+}
+
+size_t junction_graph_t::bytes() const {
+    return (node_of.size() + edge_of.size() + offset_of.size() + node_cell.size() + adjacency_first.size() +
+            adjacency.size() + corridor_cells.size()) * sizeof(int) + edges.size() * sizeof(edge_t);
+}
@@ -0,0 +1,70 @@
+#ifndef JUNCTION_H
+#define JUNCTION_H
+
+#include <cstddef>
+#include <vector>
+
+#include "wallmap.h"
+
+/* corridor-compressed maze
+ *
+ * the nodes are the junctions and dead ends of a maze, every cell with other
+ * than two ways out; the edges are the corridors between them, weighted by
+ * their length in steps. a cell that is not a node lies on exactly one
+ * corridor, at some offset from its first end, so a search can start and
+ * stop anywhere. searches then run over the nodes only: about 1.5x fewer
+ * than the cells on prim, kruskal or wilson mazes, about 5x fewer on the
+ * long corridors of backtracker ones.
+ *
+ * cells are y * width + x, paths are expanded positions like maze_t::hint.
+ */
+class junction_graph_t {
+public:
+    junction_graph_t();
+
+    void build(const wallmap_t &walls);
+
+    /* steps from cell from to cell to, -1 if there is no path */
+    int distance(int from, int to);
+
+    /* fills path with the positions from cell from to cell to like solver_t,
+     * returns 0 if there is no path */
+    int solve(int from, int to, std::vector<int> &path);
+
+    int node_count() const { return (int) node_cell.size(); }
+    int edge_count() const { return (int) edges.size(); }
+    size_t bytes() const;
+
+    long long expanded;                 //nodes settled by the last search
+
+private:
+    typedef struct {
+        int a, b;                       //end nodes
+        int length;                     //steps from a to b
+        int first;                      //first corridor cell in corridor_cells, from a
+    } edge_t;
+
+    int trace(const wallmap_t &walls, int node, int dir);
+    int cell_at(int edge, int offset) const;
+    int search(int from, int to);
+    void push(int at, int node, size_t &last);
+
+    int width;
+    int height;
+    std::vector<int> node_of;           //per cell, -1 if it lies on a corridor
+    std::vector<int> edge_of;           //per corridor cell
+    std::vector<int> offset_of;         //per corridor cell, steps from the a end of its edge
+    std::vector<int> node_cell;
+    std::vector<int> adjacency_first;   //edges of node n: adjacency[adjacency_first[n] .. adjacency_first[n + 1])
+    std::vector<int> adjacency;
+    std::vector<edge_t> edges;
+    std::vector<int> corridor_cells;
+
+    /* search state, per node */
+    std::vector<int> cost;
+    std::vector<int> parent_edge;       //-1 for the nodes the search started from
+    int reached_by;                     //the end node the goal was reached from, -1 along one corridor
+    std::vector<std::vector<int>> open; //nodes by cost, kept between searches
+};
+
+#endif
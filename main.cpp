@@ -2,6 +2,7 @@
 #include "macro.h"
 
 #include <cstdlib>
+#include <cstring>
 #include <iostream>
 
 void instruction(int &difficulty, int &color_accent, int &players, int &timing) {
@@ -20,6 +21,12 @@ void instruction(int &difficulty, int &color_accent, int &players, int &timing)
         std::cout << "Please enter color_accent(0~9)...\n";
         std::cin >> color_accent;
     }
+    std::cout << "Please enter players(1~9)...\n";
+    std::cin >> players;
+    while (players < 1 || players > 9) {
+        std::cout << "Please enter players(1~9)...\n";
+        std::cin >> players;
+    }
     std::cout << "Would you enable timing? (1=Y, 0=N)...\n";
     std::cin >> timing;
     while (timing != 0 && timing != 1) {
@@ -29,9 +36,35 @@ void instruction(int &difficulty, int &color_accent, int &players, int &timing)
     std::cout << "Loading...\n\n";
 }
 
-int main() {
+int main(int argc, char *argv[]) {
     int difficulty = 0, color_accent = 1, players = 1, timing = 1;
+    const char *generator = "prim";
+    long long seed = -1;
+    int maze_file_count = 0;
+    int infinite = 0;
+    int rgba8 = 0;
+    int arg = 1;
+    /* Maze [rgba8] [infinite] [generator [seed]], see generator_list for the names
+     * Maze [rgba8] file.maze ..., plays pre-generated mazes, see mazefile.h
+     * rgba8 draws with 8 bit framebuffers */
+    if (argc > arg && strcmp(argv[arg], "rgba8") == 0) {
+        rgba8 = 1;
+        ++arg;
+    }
+    if (argc > arg && strlen(argv[arg]) > 5 && strcmp(argv[arg] + strlen(argv[arg]) - 5, ".maze") == 0) {
+        maze_file_count = argc - arg;
+    } else {
+        if (argc > arg && strcmp(argv[arg], "infinite") == 0) {
+            infinite = 1;
+            ++arg;
+        }
+        if (argc > arg)
+            generator = argv[arg];
+        if (argc > arg + 1)
+            seed = atoll(argv[arg + 1]);
+    }
     instruction(difficulty, color_accent, players, timing);
-    main_loop(difficulty, color_accent, players, timing);
+    main_loop(difficulty, color_accent, players, timing, generator, seed, argv + arg, maze_file_count, infinite,
+              rgba8);
     return 0;
 }
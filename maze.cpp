@@ -0,0 +1,33 @@
+#include "maze.h"
+
+using namespace std;
+
+maze_t::maze_t(int w, int h) : width(w), height(h), seed(0), generator(&generator_list[0]), mazemap(w, h),
+                               keep_field(false) {
+}
+
+generator_stats_t maze_t::refresh(uint64_t seed) {
+    this->seed = seed;
+    hint.clear();
+    generator_stats_t stats = generator_run(generator, mazemap, seed);
+    if (keep_field)
+        update_field();
+    else
+        release_field();
+    return stats;
+}
+
+void maze_t::solve(int pos) {
+    if (distance.empty())
+        update_field();
+    maze_solve(*this, pos);
+}
+
+void maze_t::update_field() {
+    maze_build_field(*this);
+}
+
+void maze_t::release_field() {
+    vector<int>().swap(distance);
+    vector<char>().swap(toward_exit);
+}
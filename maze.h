@@ -0,0 +1,196 @@
+#ifndef MAZE_H
+#define MAZE_H
+
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+
+#include "wallmap.h"
+#include "generator.h"
+
+/* maze management
+ *
+ * "1" in mazemap stands for walls
+ * "0" in mazemap stands for ground
+ * mazemap only stores the walls between cells, see wallmap_t in wallmap.h
+ *
+ * positions are indices into the expanded (2w+1)x(2h+1) grid, the exit is
+ * the bottom-right cell at 4 * width. draw() and draw_hint() belong to the
+ * game and live in gamelogic.cpp.
+ */
+class maze_t {
+public:
+    maze_t(int, int);
+
+    /* the same generator and seed always give the same maze; the distance
+     * field is dropped, and rebuilt afterwards only if keep_field is set */
+    generator_stats_t refresh(uint64_t seed);
+    void draw();
+    void draw_hint();
+
+    int width;
+    int height;
+    uint64_t seed;
+    const generator_t *generator;
+    wallmap_t mazemap;
+
+    /* fills hint with the path from pos to the exit */
+    void solve(int pos);
+    /* must follow any change of mazemap made outside refresh(); an empty
+     * field is built by the next solve() */
+    void update_field();
+    /* frees the memory of the field, not just its contents */
+    void release_field();
+
+    std::vector<int> hint;
+    std::vector<int> distance;          //cells to the exit, per cell, -1 if unreachable
+    std::vector<char> toward_exit;      //DIR_* of the next step to the exit, per cell, -1 at the exit
+    bool keep_field;                    //false by default: the field is built by the first solve()
+};
+
+/* the distance field and the hint, shared with fixed_maze_t in fixedmaze.h:
+ * maze_type has width, height, mazemap, distance, toward_exit and hint like
+ * maze_t.
+ *
+ * the exit never moves, so one breadth-first search from it after every
+ * change of the walls gives each cell its distance to the exit and the
+ * direction of its next step there. any hint is then read off the field in
+ * O(path), without a search */
+template <class maze_type>
+void maze_build_field(maze_type &maze) {
+    int maze_size = maze.width * maze.height;
+    int exit = maze.width - 1;          //the bottom-right cell
+    std::vector<int> queue;
+    queue.reserve(maze_size);
+
+    maze.distance.assign(maze_size, -1);
+    maze.toward_exit.assign(maze_size, -1);
+    maze.distance[exit] = 0;
+    queue.push_back(exit);
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int cur = queue[head];
+        for (int dir = 0; dir < 4; ++dir) {
+            if (maze.mazemap.wall(cur, dir))
+                continue;
+            int next = maze.mazemap.neighbour(cur, dir);
+            if (maze.distance[next] >= 0)
+                continue;
+            maze.distance[next] = maze.distance[cur] + 1;
+            maze.toward_exit[next] = (char) (dir ^ 1);      //DIR_UP <-> DIR_DOWN, DIR_LEFT <-> DIR_RIGHT
+            queue.push_back(next);
+        }
+    }
+}
+
+/* follows toward_exit from pos, a cell or a gap between two cells of the
+ * expanded grid; hint is left empty if pos is a wall or can not reach the exit */
+template <class maze_type>
+void maze_solve(maze_type &maze, int pos) {
+    int rmw = maze.width * 2 + 1;
+    int x = pos % rmw;
+    int y = pos / rmw;
+    int cell;
+
+    maze.hint.clear();
+    if (maze.mazemap[pos])
+        return;
+    if ((x & 1) && (y & 1)) {
+        cell = y / 2 * maze.width + x / 2;
+    } else {
+        /* a gap: go on from the side closer to the exit */
+        int a = (x & 1) ? (y / 2 - 1) * maze.width + x / 2 : y / 2 * maze.width + x / 2 - 1;
+        int b = (x & 1) ? y / 2 * maze.width + x / 2 : y / 2 * maze.width + x / 2;
+        cell = maze.distance[a] < maze.distance[b] ? a : b;
+        maze.hint.push_back(pos);
+    }
+    if (maze.distance[cell] < 0) {
+        maze.hint.clear();
+        return;
+    }
+    maze.hint.reserve(maze.hint.size() + maze.distance[cell] * 2 + 1);
+    while (true) {
+        int at = (cell / maze.width * 2 + 1) * rmw + cell % maze.width * 2 + 1;
+        maze.hint.push_back(at);
+        if (maze.distance[cell] == 0)
+            break;
+        int dir = maze.toward_exit[cell];
+        maze.hint.push_back(at + offr[dir] * rmw + offc[dir]);
+        cell = maze.mazemap.neighbour(cell, dir);
+    }
+}
+
+/* the position after pos, a cell or a gap, on its hint; -1 at the exit or
+ * if pos is a wall or can not reach the exit. the field of maze must be built */
+template <class maze_type>
+int maze_hint_next(const maze_type &maze, int pos) {
+    int rmw = maze.width * 2 + 1;
+    int x = pos % rmw;
+    int y = pos / rmw;
+
+    if (maze.mazemap[pos])
+        return -1;
+    if ((x & 1) && (y & 1)) {
+        int cell = y / 2 * maze.width + x / 2;
+        if (maze.distance[cell] <= 0)
+            return -1;
+        int dir = maze.toward_exit[cell];
+        return pos + offr[dir] * rmw + offc[dir];
+    }
+    /* a gap: the side closer to the exit, as in maze_solve() */
+    int a = (x & 1) ? (y / 2 - 1) * maze.width + x / 2 : y / 2 * maze.width + x / 2 - 1;
+    int b = (x & 1) ? y / 2 * maze.width + x / 2 : y / 2 * maze.width + x / 2;
+    int cell = maze.distance[a] < maze.distance[b] ? a : b;
+    if (maze.distance[cell] < 0)
+        return -1;
+    return (cell / maze.width * 2 + 1) * rmw + cell % maze.width * 2 + 1;
+}
+
+/* the hints of several players at once
+ *
+ * the hints of all positions follow the same field toward the exit, so they
+ * form one tree and the hints of any players are the part of it between
+ * them and the exit. ref counts, per expanded position, the players on it
+ * and the covered positions whose hint goes on through it; a position is on
+ * some hint while its count is not 0. adding or removing a player walks its
+ * hint only up to where it joins another, so showing the hints of n players
+ * costs their union rather than n walks, and a step of one player costs
+ * O(1) on a perfect maze.
+ *
+ * every call appends the positions whose covered() flipped to changed, some
+ * maybe twice. the field of maze must be built.
+ */
+class hint_cover_t {
+public:
+    /* size is the number of expanded positions */
+    void reset(int size) {
+        ref.assign(size, 0);
+    }
+
+    bool covered(int pos) const {
+        return ref[pos] > 0;
+    }
+
+    template <class maze_type>
+    void add(const maze_type &maze, int pos, std::vector<int> &changed) {
+        for (; pos >= 0 && ref[pos]++ == 0; pos = maze_hint_next(maze, pos))
+            changed.push_back(pos);
+    }
+
+    template <class maze_type>
+    void remove(const maze_type &maze, int pos, std::vector<int> &changed) {
+        for (; pos >= 0 && --ref[pos] == 0; pos = maze_hint_next(maze, pos))
+            changed.push_back(pos);
+    }
+
+    /* a player stepped from one position to another */
+    template <class maze_type>
+    void move(const maze_type &maze, int from, int to, std::vector<int> &changed) {
+        add(maze, to, changed);
+        remove(maze, from, changed);
+    }
+
+private:
+    std::vector<int> ref;
+};
+
+#endif
@@ -0,0 +1,162 @@
+#include <climits>
+#include <cstdio>
+#include <cstring>
+
+#include <vector>
+
+#include "mazefile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+
+/* binary files */
+
+/* the file is little-endian and used as it is, see mazefile.h */
+static bool host_little_endian(void) {
+    const uint32_t one = 1;
+    unsigned char first;
+    memcpy(&first, &one, 1);
+    return first == 1;
+}
+
+FILE *mazefile_begin(const char *filename, int width, int height, uint64_t seed, const char *algorithm) {
+    mazefile_header_t header;
+    if (!host_little_endian())
+        return NULL;
+    FILE *file = fopen(filename, "wb");
+    if (file == NULL)
+        return NULL;
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "MAZE", 4);
+    header.version = MAZEFILE_VERSION;
+    header.width = (uint32_t) width;
+    header.height = (uint32_t) height;
+    header.seed = seed;
+    strncpy(header.algorithm, algorithm ? algorithm : "", sizeof(header.algorithm) - 1);
+    header.words_per_row = (uint32_t) (width + 63) / 64;
+    header.header_size = sizeof(header);
+    fwrite(&header, sizeof(header), 1, file);
+    return file;
+}
+
+void mazefile_write_row(const maze_row_t *row, void *file) {
+    fwrite(row->right, sizeof(uint64_t), row->words_per_row, (FILE *) file);
+    fwrite(row->up, sizeof(uint64_t), row->words_per_row, (FILE *) file);
+}
+
+int mazefile_end(FILE *file) {
+    int failed = ferror(file);
+    return fclose(file) == 0 && !failed;
+}
+
+int mazefile_save(const maze_t &maze, const char *filename) {
+    const wallmap_t &walls = maze.mazemap;
+    FILE *file = mazefile_begin(filename, walls.width, walls.height, maze.seed,
+                                maze.generator ? maze.generator->name : NULL);
+    if (file == NULL)
+        return 0;
+    fwrite(walls.data(), 1, walls.bytes(), file);
+    return mazefile_end(file);
+}
+
+/* maps the whole file copy-on-write, returns NULL on failure */
+static shared_ptr<void> map_file(const char *filename, size_t *size) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE)
+        return NULL;
+    LARGE_INTEGER file_size;
+    HANDLE mapping = NULL;
+    void *view = NULL;
+    if (GetFileSizeEx(file, &file_size) && file_size.QuadPart > 0)
+        mapping = CreateFileMappingA(file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (mapping != NULL) {
+        view = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+    if (view == NULL)
+        return NULL;
+    *size = (size_t) file_size.QuadPart;
+    return shared_ptr<void>(view, [](void *view) { UnmapViewOfFile(view); });
+#else
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+    struct stat st;
+    void *view = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && st.st_size > 0)
+        view = mmap(NULL, (size_t) st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED)
+        return NULL;
+    size_t length = (size_t) st.st_size;
+    *size = length;
+    return shared_ptr<void>(view, [length](void *view) { munmap(view, length); });
+#endif
+}
+
+int mazefile_load(maze_t &maze, const char *filename) {
+    size_t size = 0;
+    if (!host_little_endian())
+        return 0;
+    shared_ptr<void> mapping = map_file(filename, &size);
+    if (!mapping || size < sizeof(mazefile_header_t))
+        return 0;
+
+    const mazefile_header_t *header = (const mazefile_header_t *) mapping.get();
+    if (memcmp(header->magic, "MAZE", 4) != 0 || header->version != MAZEFILE_VERSION)
+        return 0;
+    if (header->width == 0 || header->height == 0 || header->header_size % 8 != 0
+        || header->header_size < sizeof(mazefile_header_t) || header->words_per_row != (header->width + 63) / 64)
+        return 0;
+    /* positions index the expanded grid as int */
+    if (((uint64_t) header->width * 2 + 1) * ((uint64_t) header->height * 2 + 1) > INT_MAX)
+        return 0;
+    uint64_t wall_bytes = (uint64_t) header->height * 2 * header->words_per_row * sizeof(uint64_t);
+    if (size < header->header_size || size - header->header_size < wall_bytes)
+        return 0;
+
+    char algorithm[sizeof(header->algorithm) + 1];
+    memcpy(algorithm, header->algorithm, sizeof(header->algorithm));
+    algorithm[sizeof(header->algorithm)] = '\0';
+    const generator_t *generator = generator_find(algorithm);
+
+    maze.width = (int) header->width;
+    maze.height = (int) header->height;
+    maze.seed = header->seed;
+    if (generator != NULL)
+        maze.generator = generator;
+    maze.hint.clear();
+    uint64_t *words = (uint64_t *) ((char *) mapping.get() + header->header_size);
+    maze.mazemap.attach(maze.width, maze.height, words, mapping);
+    /* built by the first solve(), so that opening stays a mapping */
+    maze.release_field();
+    return 1;
+}
+
+/* text files */
+
+int mazefile_save_text(const wallmap_t &walls, const char *filename) {
+    int rmw = walls.width * 2 + 1, rmh = walls.height * 2 + 1;
+    vector<char> line(rmw + 1, '\n');
+    FILE *file = fopen(filename, "wb");
+    if (file == NULL)
+        return 0;
+    for (int y = 0; y < rmh; ++y) {
+        for (int x = 0; x < rmw; ++x)
+            line[x] = walls[y * rmw + x] ? '#' : ' ';
+        fwrite(line.data(), 1, rmw + 1, file);
+    }
+    return fclose(file) == 0;
+}
@@ -0,0 +1,55 @@
+#ifndef MAZEFILE_H
+#define MAZEFILE_H
+
+#include <cstdint>
+#include <cstdio>
+
+#include "wallmap.h"
+#include "eller.h"
+#include "maze.h"
+
+/* maze input/output */
+
+/* binary maze file, version 1
+ *
+ * a mazefile_header_t, then the walls exactly as wallmap_t keeps them in
+ * memory: height rows of words_per_row 64-bit words of right walls followed
+ * by words_per_row words of up walls. the header is a multiple of 8 bytes,
+ * so the walls can be used in place from a mapping.
+ *
+ * all of the file is little-endian. as the walls are used in place and not
+ * converted, big-endian hosts can neither write nor read maze files.
+ */
+#define MAZEFILE_VERSION 1
+
+typedef struct {
+    char magic[4];              /* "MAZE" */
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint64_t seed;
+    char algorithm[16];         /* generator name, zero padded */
+    uint32_t words_per_row;
+    uint32_t header_size;       /* offset of the walls */
+} mazefile_header_t;
+
+int mazefile_save(const maze_t &maze, const char *filename);
+
+/* maps the file instead of reading it, so even huge mazes open without a
+ * parse step; pages are copy-on-write, refreshing the maze never touches the
+ * file. returns 0 if the file can not be opened, is not a maze file or has
+ * an expanded (2w+1)x(2h+1) grid too big for an int index */
+int mazefile_load(maze_t &maze, const char *filename);
+
+/* streaming writer: rows must arrive in order from y = 0, e.g. as the sink
+ * of eller_generate(width, height, seed, mazefile_write_row, file) on the
+ * file returned by mazefile_begin() */
+FILE *mazefile_begin(const char *filename, int width, int height, uint64_t seed, const char *algorithm);
+void mazefile_write_row(const maze_row_t *row, void *file);
+int mazefile_end(FILE *file);
+
+/* text: '#' for walls and ' ' for ground in the expanded (2w+1)x(2h+1)
+ * layout, bottom row first, the same as eller_write_file; returns 0 on failure */
+int mazefile_save_text(const wallmap_t &walls, const char *filename);
+
+#endif
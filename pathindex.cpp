@@ -0,0 +1,130 @@
+#include <cassert>
+#include <algorithm>
+
+#include "pathindex.h"
+#include "wallmap.h"
+
+using namespace std;
+
+path_index_t::path_index_t() : width(0), height(0) {}
+
+void path_index_t::build(int width, int height, const vector<int> &distance, const vector<char> &toward_exit) {
+    int maze_size = width * height;
+    assert(width > 0 && height > 0);
+    assert((int) distance.size() == maze_size && (int) toward_exit.size() == maze_size);
+    this->width = width;
+    this->height = height;
+    depth.assign(distance.begin(), distance.end());
+    up.assign(toward_exit.begin(), toward_exit.end());
+    jump.assign(maze_size, 0);
+
+    /* parents need their jump before their children: counting sort by depth */
+    int max_depth = 0;
+    for (int d : depth)
+        max_depth = max(max_depth, d);
+    vector<int> first(max_depth + 2, 0);
+    for (int d : depth)
+        if (d >= 0)
+            ++first[d + 1];
+    for (int d = 0; d <= max_depth; ++d)
+        first[d + 1] += first[d];
+    vector<int> order(first[max_depth + 1]);
+    for (int cell = 0; cell < maze_size; ++cell)
+        if (depth[cell] >= 0)
+            order[first[depth[cell]]++] = cell;
+
+    for (int cell = 0; cell < maze_size; ++cell)
+        jump[cell] = cell;              //roots and unreachable cells
+    for (int cell : order) {
+        if (depth[cell] == 0)
+            continue;
+        int p = parent(cell);
+        int j = jump[p];
+        /* two jumps of the same length combine into one */
+        if (depth[p] - depth[j] == depth[j] - depth[jump[j]])
+            jump[cell] = jump[j];
+        else
+            jump[cell] = p;
+    }
+}
+
+int path_index_t::parent(int cell) const {
+    switch (up[cell]) {
+        case DIR_UP:
+            return cell + width;
+        case DIR_DOWN:
+            return cell - width;
+        case DIR_LEFT:
+            return cell - 1;
+        case DIR_RIGHT:
+            return cell + 1;
+        default:
+            return cell;
+    }
+}
+
+int path_index_t::position(int cell) const {
+    return (cell / width * 2 + 1) * (width * 2 + 1) + cell % width * 2 + 1;
+}
+
+int path_index_t::ancestor(int cell, int depth) const {
+    assert(depth >= 0 && depth <= this->depth[cell]);
+    while (this->depth[cell] > depth) {
+        if (this->depth[jump[cell]] >= depth)
+            cell = jump[cell];
+        else
+            cell = parent(cell);
+    }
+    return cell;
+}
+
+int path_index_t::lca(int a, int b) const {
+    if (depth[a] < 0 || depth[b] < 0)
+        return -1;
+    if (depth[a] < depth[b])
+        swap(a, b);
+    a = ancestor(a, depth[b]);
+    /* a and b are at the same depth from here, so their jumps have the same length */
+    while (a != b) {
+        if (jump[a] != jump[b]) {
+            a = jump[a];
+            b = jump[b];
+        } else {
+            a = parent(a);
+            b = parent(b);
+        }
+    }
+    return a;
+}
+
+int path_index_t::distance(int a, int b) const {
+    int c = lca(a, b);
+    if (c < 0)
+        return -1;
+    return depth[a] + depth[b] - 2 * depth[c];
+}
+
+void path_index_t::path(int a, int b, vector<int> &path) const {
+    path.clear();
+    int c = lca(a, b);
+    if (c < 0)
+        return;
+    path.reserve((depth[a] + depth[b] - 2 * depth[c]) * 2 + 1);
+
+    /* up from a, then the way up from b backwards; a gap is halfway between two cells */
+    for (int cell = a; cell != c; cell = parent(cell)) {
+        path.push_back(position(cell));
+        path.push_back((position(cell) + position(parent(cell))) / 2);
+    }
+    size_t middle = path.size();
+    for (int cell = b; cell != c; cell = parent(cell)) {
+        path.push_back(position(cell));
+        path.push_back((position(cell) + position(parent(cell))) / 2);
+    }
+    path.push_back(position(c));
+    reverse(path.begin() + middle, path.end());
+}
+
+size_t path_index_t::bytes() const {
+    return depth.size() * sizeof(int) + jump.size() * sizeof(int) + up.size();
+}
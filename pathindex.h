@@ -0,0 +1,53 @@
+#ifndef PATHINDEX_H
+#define PATHINDEX_H
+
+#include <cstddef>
+#include <vector>
+
+/* point to point queries on a perfect maze
+ *
+ * a perfect maze is a tree; rooted at the exit it is exactly the distance
+ * field of maze_t (see maze_build_field() in maze.h): distance is the depth
+ * of a cell and toward_exit leads to its parent. the path between two cells
+ * goes up from both to their lowest common ancestor.
+ *
+ * besides its parent every cell keeps one jump pointer to an ancestor, chosen
+ * so that any ancestor is reached in O(log n) jumps (the skew-binary jump
+ * pointers of Myers), which keeps the index at O(n) memory where binary
+ * lifting would need O(n log n).
+ *
+ * cells are y * width + x, paths are expanded positions like maze_t::hint.
+ */
+class path_index_t {
+public:
+    path_index_t();
+
+    /* maze_type is maze_t or fixed_maze_t, its field must be built */
+    template <class maze_type>
+    void build(const maze_type &maze) {
+        build(maze.width, maze.height, maze.distance, maze.toward_exit);
+    }
+    void build(int width, int height, const std::vector<int> &distance, const std::vector<char> &toward_exit);
+
+    int ancestor(int cell, int depth) const;    //the ancestor of cell at depth
+    int lca(int a, int b) const;
+    int distance(int a, int b) const;           //steps between the cells of a and b
+
+    /* fills path with the positions from cell a to cell b, both included */
+    void path(int a, int b, std::vector<int> &path) const;
+
+    size_t bytes() const;
+
+    int width;
+    int height;
+
+private:
+    int parent(int cell) const;
+    int position(int cell) const;
+
+    std::vector<int> depth;
+    std::vector<int> jump;
+    std::vector<char> up;               //toward_exit
+};
+
+#endif
@@ -1,4 +1,5 @@
 #include <cassert>
+#include <cstring>
 #include "graphics.h"
 #include "image.h"
 #include "maths.h"
@@ -69,7 +70,10 @@ static vec4_t get_buffer_val(framebuffer_t *buffer, int row, int col) {
     return buffer->colorbuffer[index];
 }
 
-void private_blit_buffer_bgr(framebuffer_t *src, image_t *dst) {
+/* the pixels range.x..range.y of buffer rows range.z..range.w, which are
+ * image rows src->height - 1 - range.w .. src->height - 1 - range.z; packed
+ * pixels are b, g, r, a in memory, which a 4 channel bgr image takes as is */
+void private_blit_buffer_bgr_rect(framebuffer_t *src, image_t *dst, ivec4_t range) {
     int width = int_min(src->width, dst->width);
     int height = int_min(src->height, dst->height);
     int r, c;
@@ -77,9 +81,26 @@ void private_blit_buffer_bgr(framebuffer_t *src, image_t *dst) {
     assert(width > 0 && height > 0);
     assert(dst->channels == 3 || dst->channels == 4);
 
-    for (r = 0; r < height; r++) {
-        for (c = 0; c < width; c++) {
-            int flipped_r = src->height - 1 - r;
+    int c0 = int_max(range.x, 0), c1 = int_min(range.y, width - 1);
+    int r0 = int_max(src->height - 1 - range.w, 0), r1 = int_min(src->height - 1 - range.z, height - 1);
+    for (r = r0; r <= r1; r++) {
+        int flipped_r = src->height - 1 - r;
+        if (src->format == FRAMEBUFFER_BGRA8) {
+            const uint32_t *src_row = src->packedbuffer + flipped_r * src->width;
+            if (dst->channels == 4) {
+                if (c0 <= c1)
+                    memcpy(get_pixel_ptr(dst, r, c0), src_row + c0, sizeof(uint32_t) * (c1 - c0 + 1));
+                continue;
+            }
+            for (c = c0; c <= c1; c++) {
+                unsigned char *dst_pixel = get_pixel_ptr(dst, r, c);
+                dst_pixel[0] = (unsigned char) src_row[c];          // blue
+                dst_pixel[1] = (unsigned char) (src_row[c] >> 8);   // green
+                dst_pixel[2] = (unsigned char) (src_row[c] >> 16);  // red
+            }
+            continue;
+        }
+        for (c = c0; c <= c1; c++) {
             vec4_t src_value = get_buffer_val(src, flipped_r, c);
             unsigned char *dst_pixel = get_pixel_ptr(dst, r, c);
             dst_pixel[0] = float_to_uchar(src_value.z);  // blue
@@ -89,6 +110,10 @@ void private_blit_buffer_bgr(framebuffer_t *src, image_t *dst) {
     }
 }
 
+void private_blit_buffer_bgr(framebuffer_t *src, image_t *dst) {
+    private_blit_buffer_bgr_rect(src, dst, ivec4_new(0, src->width - 1, 0, src->height - 1));
+}
+
 void private_blit_buffer_rgb(framebuffer_t *src, image_t *dst) {
     int width = int_min(src->width, dst->width);
     int height = int_min(src->height, dst->height);
@@ -100,8 +125,15 @@ void private_blit_buffer_rgb(framebuffer_t *src, image_t *dst) {
     for (r = 0; r < height; r++) {
         for (c = 0; c < width; c++) {
             int flipped_r = src->height - 1 - r;
-            vec4_t src_value = get_buffer_val(src, flipped_r, c);
             unsigned char *dst_pixel = get_pixel_ptr(dst, r, c);
+            if (src->format == FRAMEBUFFER_BGRA8) {
+                uint32_t pixel = src->packedbuffer[flipped_r * src->width + c];
+                dst_pixel[0] = (unsigned char) (pixel >> 16);  /* red */
+                dst_pixel[1] = (unsigned char) (pixel >> 8);   /* green */
+                dst_pixel[2] = (unsigned char) pixel;          /* blue */
+                continue;
+            }
+            vec4_t src_value = get_buffer_val(src, flipped_r, c);
             dst_pixel[0] = float_to_uchar(src_value.x);  /* red */
             dst_pixel[1] = float_to_uchar(src_value.y);  /* green */
             dst_pixel[2] = float_to_uchar(src_value.z);  /* blue */
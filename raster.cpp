@@ -0,0 +1,433 @@
+#include <cmath>
+#include <cstring>
+
+#include "raster.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RASTER_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+/* the vector kernels are built for their instruction set whatever the
+ * compiler targets, and only called once the cpu is known to have it */
+#if defined(_MSC_VER)
+#define RASTER_TARGET(isa)
+#else
+#define RASTER_TARGET(isa) __attribute__((target(isa)))
+#endif
+
+static inline uint32_t pack_channel(float value) {
+    /* not fmaxf / fminf, which are calls unless nans may be ignored */
+    value = value < 1.0f ? value : 1.0f;
+    value = value > 0.0f ? value : 0.0f;
+    return (uint32_t) (value * 255 + 0.5f);
+}
+
+uint32_t raster_pack(vec4_t color) {
+    return pack_channel(color.z) | pack_channel(color.y) << 8 | pack_channel(color.x) << 16 |
+           pack_channel(color.w) << 24;
+}
+
+vec4_t raster_unpack(uint32_t pixel) {
+    const float scale = 1.0f / 255;
+    return vec4_new((pixel >> 16 & 0xff) * scale, (pixel >> 8 & 0xff) * scale, (pixel & 0xff) * scale,
+                    (pixel >> 24) * scale);
+}
+
+/* scalar: the maths of boxSDF, circleSDF and capsuleSDF in graphics.cpp.
+ * every kernel is a template over the pixel, vec4_t or packed */
+
+static inline void blend_pixel(vec4_t *pixel, float alpha, vec3_t color) {
+    pixel->x = pixel->x * (1 - alpha) + color.x * alpha;
+    pixel->y = pixel->y * (1 - alpha) + color.y * alpha;
+    pixel->z = pixel->z * (1 - alpha) + color.z * alpha;
+}
+
+static inline void blend_pixel(uint32_t *pixel, float alpha, vec3_t color) {
+    if (alpha <= 0.0f)
+        return;
+    vec4_t value = raster_unpack(*pixel);
+    blend_pixel(&value, alpha, color);
+    *pixel = raster_pack(value);
+}
+
+static inline float coverage(float v) {
+    return fmaxf(fminf(v, 1.0f), 0.0f);
+}
+
+template <class pixel_t>
+static void box_scalar(pixel_t *row, int x0, int x1, float y, const raster_box_t *box, vec3_t color) {
+    float py = y - box->cy;
+    for (int x = x0; x <= x1; x++) {
+        float px = x - box->cx;
+        float dx = fabsf(px * box->cos_theta + py * box->sin_theta) - box->half_w;
+        float dy = fabsf(py * box->cos_theta - px * box->sin_theta) - box->half_h;
+        float ax = fmaxf(dx, 0.0f), ay = fmaxf(dy, 0.0f);
+        float sdf = fminf(fmaxf(dx, dy), 0.0f) + sqrtf(ax * ax + ay * ay);
+        blend_pixel(row + x, coverage(0.5f - sdf + box->r), color);
+    }
+}
+
+template <class pixel_t>
+static void circle_scalar(pixel_t *row, int x0, int x1, float y, const raster_circle_t *circle, vec3_t color) {
+    double uy = y - circle->cy;
+    for (int x = x0; x <= x1; x++) {
+        double ux = x - circle->cx;
+        float sdf = sqrtf(ux * ux + uy * uy) - circle->r;
+        blend_pixel(row + x, coverage(0.5f - sdf), color);
+    }
+}
+
+template <class pixel_t>
+static void capsule_scalar(pixel_t *row, int x0, int x1, float y, const raster_capsule_t *capsule, vec3_t color) {
+    float bax = capsule->bx - capsule->ax, bay = capsule->by - capsule->ay;
+    float pay = y - capsule->ay;
+    for (int x = x0; x <= x1; x++) {
+        float pax = x - capsule->ax;
+        float h = fmaxf(fminf((pax * bax + pay * bay) / (bax * bax + bay * bay), 1.0f), 0.0f);
+        float dx = pax - bax * h, dy = pay - bay * h;
+        float sdf = sqrtf(dx * dx + dy * dy) - capsule->r;
+        blend_pixel(row + x, coverage(0.5f - sdf), color);
+    }
+}
+
+static int supported_always(void) {
+    return 1;
+}
+
+#ifdef RASTER_X86
+
+static int supported_sse2(void) {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[3] >> 26) & 1;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2");
+#endif
+}
+
+static int supported_avx2(void) {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return 0;
+    /* the os must save the ymm registers too */
+    __cpuid(info, 1);
+    if (!((info[2] >> 27) & 1) || !((info[2] >> 28) & 1) || (_xgetbv(0) & 6) != 6)
+        return 0;
+    __cpuidex(info, 7, 0);
+    return (info[1] >> 5) & 1;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+/* sse2: 4 pixels a step. a pixel is one vec4_t, so it is blended as one
+ * register with its alpha in every lane but w, which keeps w as it is */
+
+#define SSE2_BLEND_LANE(i)                                                                  \
+    do {                                                                                    \
+        __m128 a = _mm_and_ps(_mm_shuffle_ps(alpha, alpha, _MM_SHUFFLE(i, i, i, i)), rgb);  \
+        __m128 v = _mm_loadu_ps(&pixels[i].x);                                              \
+        v = _mm_add_ps(_mm_mul_ps(v, _mm_sub_ps(one, a)), _mm_mul_ps(color, a));            \
+        _mm_storeu_ps(&pixels[i].x, v);                                                     \
+    } while (0)
+
+RASTER_TARGET("sse2")
+static inline void blend_sse2(vec4_t *pixels, __m128 alpha, __m128 color) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 rgb = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    if (_mm_movemask_ps(_mm_cmpgt_ps(alpha, _mm_setzero_ps())) == 0)
+        return;
+    SSE2_BLEND_LANE(0);
+    SSE2_BLEND_LANE(1);
+    SSE2_BLEND_LANE(2);
+    SSE2_BLEND_LANE(3);
+}
+
+/* packed pixels are widened to one register each, reordered from b, g, r, a
+ * to the r, g, b, a of color, and rounded back the way raster_pack() does;
+ * packing saturates, so there is nothing to clamp */
+RASTER_TARGET("sse2")
+static inline __m128 unpack_sse2(uint32_t pixel) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i bytes = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128((int) pixel), zero), zero);
+    __m128 v = _mm_mul_ps(_mm_cvtepi32_ps(bytes), _mm_set1_ps(1.0f / 255));
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 1, 2));
+}
+
+RASTER_TARGET("sse2")
+static inline uint32_t pack_sse2(__m128 v) {
+    v = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 0, 1, 2));
+    __m128i words = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(v, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+    words = _mm_packs_epi32(words, words);
+    return (uint32_t) _mm_cvtsi128_si32(_mm_packus_epi16(words, words));
+}
+
+#define SSE2_BLEND_PACKED_LANE(i)                                                           \
+    do {                                                                                    \
+        __m128 a = _mm_and_ps(_mm_shuffle_ps(alpha, alpha, _MM_SHUFFLE(i, i, i, i)), rgb);  \
+        __m128 v = unpack_sse2(pixels[i]);                                                  \
+        v = _mm_add_ps(_mm_mul_ps(v, _mm_sub_ps(one, a)), _mm_mul_ps(color, a));            \
+        pixels[i] = pack_sse2(v);                                                           \
+    } while (0)
+
+RASTER_TARGET("sse2")
+static inline void blend_sse2(uint32_t *pixels, __m128 alpha, __m128 color) {
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 rgb = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    if (_mm_movemask_ps(_mm_cmpgt_ps(alpha, _mm_setzero_ps())) == 0)
+        return;
+    SSE2_BLEND_PACKED_LANE(0);
+    SSE2_BLEND_PACKED_LANE(1);
+    SSE2_BLEND_PACKED_LANE(2);
+    SSE2_BLEND_PACKED_LANE(3);
+}
+
+RASTER_TARGET("sse2")
+static inline __m128 coverage_sse2(__m128 v) {
+    return _mm_min_ps(_mm_max_ps(v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+}
+
+template <class pixel_t>
+RASTER_TARGET("sse2")
+static void box_sse2(pixel_t *row, int x0, int x1, float y, const raster_box_t *box, vec3_t color) {
+    const __m128 abs_mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    const __m128 zero = _mm_setzero_ps();
+    __m128 rgb = _mm_setr_ps(color.x, color.y, color.z, 0);
+    __m128 cos_theta = _mm_set1_ps(box->cos_theta), sin_theta = _mm_set1_ps(box->sin_theta);
+    __m128 half_w = _mm_set1_ps(box->half_w), half_h = _mm_set1_ps(box->half_h);
+    __m128 py = _mm_set1_ps(y - box->cy);
+    __m128 px = _mm_sub_ps(_mm_add_ps(_mm_set1_ps((float) x0), _mm_setr_ps(0, 1, 2, 3)), _mm_set1_ps(box->cx));
+    __m128 offset = _mm_set1_ps(0.5f + box->r);
+    int x = x0;
+    for (; x + 3 <= x1; x += 4, px = _mm_add_ps(px, _mm_set1_ps(4.0f))) {
+        __m128 dx = _mm_add_ps(_mm_mul_ps(px, cos_theta), _mm_mul_ps(py, sin_theta));
+        __m128 dy = _mm_sub_ps(_mm_mul_ps(py, cos_theta), _mm_mul_ps(px, sin_theta));
+        dx = _mm_sub_ps(_mm_and_ps(dx, abs_mask), half_w);
+        dy = _mm_sub_ps(_mm_and_ps(dy, abs_mask), half_h);
+        __m128 ax = _mm_max_ps(dx, zero), ay = _mm_max_ps(dy, zero);
+        __m128 sdf = _mm_add_ps(_mm_min_ps(_mm_max_ps(dx, dy), zero),
+                                _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(ax, ax), _mm_mul_ps(ay, ay))));
+        blend_sse2(row + x, coverage_sse2(_mm_sub_ps(offset, sdf)), rgb);
+    }
+    if (x <= x1)
+        box_scalar(row, x, x1, y, box, color);
+}
+
+template <class pixel_t>
+RASTER_TARGET("sse2")
+static void circle_sse2(pixel_t *row, int x0, int x1, float y, const raster_circle_t *circle, vec3_t color) {
+    __m128 rgb = _mm_setr_ps(color.x, color.y, color.z, 0);
+    float uy = y - circle->cy;
+    __m128 uy2 = _mm_set1_ps(uy * uy);
+    __m128 ux = _mm_sub_ps(_mm_add_ps(_mm_set1_ps((float) x0), _mm_setr_ps(0, 1, 2, 3)), _mm_set1_ps(circle->cx));
+    __m128 offset = _mm_set1_ps(0.5f + circle->r);
+    int x = x0;
+    for (; x + 3 <= x1; x += 4, ux = _mm_add_ps(ux, _mm_set1_ps(4.0f))) {
+        __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(ux, ux), uy2));
+        blend_sse2(row + x, coverage_sse2(_mm_sub_ps(offset, distance)), rgb);
+    }
+    if (x <= x1)
+        circle_scalar(row, x, x1, y, circle, color);
+}
+
+template <class pixel_t>
+RASTER_TARGET("sse2")
+static void capsule_sse2(pixel_t *row, int x0, int x1, float y, const raster_capsule_t *capsule, vec3_t color) {
+    const __m128 zero = _mm_setzero_ps(), one = _mm_set1_ps(1.0f);
+    __m128 rgb = _mm_setr_ps(color.x, color.y, color.z, 0);
+    float bax = capsule->bx - capsule->ax, bay = capsule->by - capsule->ay;
+    float pay = y - capsule->ay;
+    __m128 ba_x = _mm_set1_ps(bax), ba_y = _mm_set1_ps(bay);
+    __m128 pa_y = _mm_set1_ps(pay), pa_y_ba_y = _mm_set1_ps(pay * bay);
+    __m128 length2 = _mm_set1_ps(bax * bax + bay * bay);
+    __m128 pa_x = _mm_sub_ps(_mm_add_ps(_mm_set1_ps((float) x0), _mm_setr_ps(0, 1, 2, 3)), _mm_set1_ps(capsule->ax));
+    __m128 offset = _mm_set1_ps(0.5f + capsule->r);
+    int x = x0;
+    for (; x + 3 <= x1; x += 4, pa_x = _mm_add_ps(pa_x, _mm_set1_ps(4.0f))) {
+        /* min() before max() like fminf() so that 0 / 0 gives 1 */
+        __m128 h = _mm_div_ps(_mm_add_ps(_mm_mul_ps(pa_x, ba_x), pa_y_ba_y), length2);
+        h = _mm_max_ps(_mm_min_ps(h, one), zero);
+        __m128 dx = _mm_sub_ps(pa_x, _mm_mul_ps(ba_x, h)), dy = _mm_sub_ps(pa_y, _mm_mul_ps(ba_y, h));
+        __m128 distance = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+        blend_sse2(row + x, coverage_sse2(_mm_sub_ps(offset, distance)), rgb);
+    }
+    if (x <= x1)
+        capsule_scalar(row, x, x1, y, capsule, color);
+}
+
+/* avx2: 8 pixels a step, blended two to a register */
+
+#define AVX2_BLEND_PAIR(i)                                                                                  \
+    do {                                                                                                    \
+        __m256i lanes = _mm256_setr_epi32(2 * i, 2 * i, 2 * i, 2 * i, 2 * i + 1, 2 * i + 1, 2 * i + 1, 2 * i + 1); \
+        __m256 a = _mm256_and_ps(_mm256_permutevar8x32_ps(alpha, lanes), rgb);                              \
+        __m256 v = _mm256_loadu_ps(&pixels[2 * i].x);                                                       \
+        v = _mm256_add_ps(_mm256_mul_ps(v, _mm256_sub_ps(one, a)), _mm256_mul_ps(color, a));                \
+        _mm256_storeu_ps(&pixels[2 * i].x, v);                                                              \
+    } while (0)
+
+RASTER_TARGET("avx2")
+static inline void blend_avx2(vec4_t *pixels, __m256 alpha, __m256 color) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 rgb = _mm256_castsi256_ps(_mm256_setr_epi32(-1, -1, -1, 0, -1, -1, -1, 0));
+    if (_mm256_movemask_ps(_mm256_cmp_ps(alpha, _mm256_setzero_ps(), _CMP_GT_OQ)) == 0)
+        return;
+    AVX2_BLEND_PAIR(0);
+    AVX2_BLEND_PAIR(1);
+    AVX2_BLEND_PAIR(2);
+    AVX2_BLEND_PAIR(3);
+}
+
+/* two packed pixels to a register, as in unpack_sse2() and pack_sse2() */
+RASTER_TARGET("avx2")
+static inline __m256 unpack_avx2(const uint32_t *pixels) {
+    __m128i bytes = _mm_loadl_epi64((const __m128i *) pixels);
+    __m256 v = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(bytes)), _mm256_set1_ps(1.0f / 255));
+    return _mm256_permute_ps(v, _MM_SHUFFLE(3, 0, 1, 2));
+}
+
+RASTER_TARGET("avx2")
+static inline void pack_avx2(uint32_t *pixels, __m256 v) {
+    v = _mm256_permute_ps(v, _MM_SHUFFLE(3, 0, 1, 2));
+    __m256i words = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_mul_ps(v, _mm256_set1_ps(255.0f)),
+                                                      _mm256_set1_ps(0.5f)));
+    __m128i halves = _mm_packs_epi32(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+    _mm_storel_epi64((__m128i *) pixels, _mm_packus_epi16(halves, halves));
+}
+
+#define AVX2_BLEND_PACKED_PAIR(i)                                                                           \
+    do {                                                                                                    \
+        __m256i lanes = _mm256_setr_epi32(2 * i, 2 * i, 2 * i, 2 * i, 2 * i + 1, 2 * i + 1, 2 * i + 1, 2 * i + 1); \
+        __m256 a = _mm256_and_ps(_mm256_permutevar8x32_ps(alpha, lanes), rgb);                              \
+        __m256 v = unpack_avx2(pixels + 2 * i);                                                             \
+        v = _mm256_add_ps(_mm256_mul_ps(v, _mm256_sub_ps(one, a)), _mm256_mul_ps(color, a));                \
+        pack_avx2(pixels + 2 * i, v);                                                                       \
+    } while (0)
+
+RASTER_TARGET("avx2")
+static inline void blend_avx2(uint32_t *pixels, __m256 alpha, __m256 color) {
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 rgb = _mm256_castsi256_ps(_mm256_setr_epi32(-1, -1, -1, 0, -1, -1, -1, 0));
+    if (_mm256_movemask_ps(_mm256_cmp_ps(alpha, _mm256_setzero_ps(), _CMP_GT_OQ)) == 0)
+        return;
+    AVX2_BLEND_PACKED_PAIR(0);
+    AVX2_BLEND_PACKED_PAIR(1);
+    AVX2_BLEND_PACKED_PAIR(2);
+    AVX2_BLEND_PACKED_PAIR(3);
+}
+
+RASTER_TARGET("avx2")
+static inline __m256 coverage_avx2(__m256 v) {
+    return _mm256_min_ps(_mm256_max_ps(v, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+}
+
+RASTER_TARGET("avx2")
+static inline __m256 first_x_avx2(int x0, float origin) {
+    return _mm256_sub_ps(_mm256_add_ps(_mm256_set1_ps((float) x0), _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7)),
+                         _mm256_set1_ps(origin));
+}
+
+template <class pixel_t>
+RASTER_TARGET("avx2")
+static void box_avx2(pixel_t *row, int x0, int x1, float y, const raster_box_t *box, vec3_t color) {
+    const __m256 abs_mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    const __m256 zero = _mm256_setzero_ps();
+    __m256 rgb = _mm256_setr_ps(color.x, color.y, color.z, 0, color.x, color.y, color.z, 0);
+    __m256 cos_theta = _mm256_set1_ps(box->cos_theta), sin_theta = _mm256_set1_ps(box->sin_theta);
+    __m256 half_w = _mm256_set1_ps(box->half_w), half_h = _mm256_set1_ps(box->half_h);
+    __m256 py = _mm256_set1_ps(y - box->cy);
+    __m256 px = first_x_avx2(x0, box->cx);
+    __m256 offset = _mm256_set1_ps(0.5f + box->r);
+    int x = x0;
+    for (; x + 7 <= x1; x += 8, px = _mm256_add_ps(px, _mm256_set1_ps(8.0f))) {
+        __m256 dx = _mm256_add_ps(_mm256_mul_ps(px, cos_theta), _mm256_mul_ps(py, sin_theta));
+        __m256 dy = _mm256_sub_ps(_mm256_mul_ps(py, cos_theta), _mm256_mul_ps(px, sin_theta));
+        dx = _mm256_sub_ps(_mm256_and_ps(dx, abs_mask), half_w);
+        dy = _mm256_sub_ps(_mm256_and_ps(dy, abs_mask), half_h);
+        __m256 ax = _mm256_max_ps(dx, zero), ay = _mm256_max_ps(dy, zero);
+        __m256 sdf = _mm256_add_ps(_mm256_min_ps(_mm256_max_ps(dx, dy), zero),
+                                   _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(ax, ax), _mm256_mul_ps(ay, ay))));
+        blend_avx2(row + x, coverage_avx2(_mm256_sub_ps(offset, sdf)), rgb);
+    }
+    if (x <= x1)
+        box_sse2(row, x, x1, y, box, color);
+}
+
+template <class pixel_t>
+RASTER_TARGET("avx2")
+static void circle_avx2(pixel_t *row, int x0, int x1, float y, const raster_circle_t *circle, vec3_t color) {
+    __m256 rgb = _mm256_setr_ps(color.x, color.y, color.z, 0, color.x, color.y, color.z, 0);
+    float uy = y - circle->cy;
+    __m256 uy2 = _mm256_set1_ps(uy * uy);
+    __m256 ux = first_x_avx2(x0, circle->cx);
+    __m256 offset = _mm256_set1_ps(0.5f + circle->r);
+    int x = x0;
+    for (; x + 7 <= x1; x += 8, ux = _mm256_add_ps(ux, _mm256_set1_ps(8.0f))) {
+        __m256 distance = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(ux, ux), uy2));
+        blend_avx2(row + x, coverage_avx2(_mm256_sub_ps(offset, distance)), rgb);
+    }
+    if (x <= x1)
+        circle_sse2(row, x, x1, y, circle, color);
+}
+
+template <class pixel_t>
+RASTER_TARGET("avx2")
+static void capsule_avx2(pixel_t *row, int x0, int x1, float y, const raster_capsule_t *capsule, vec3_t color) {
+    const __m256 zero = _mm256_setzero_ps(), one = _mm256_set1_ps(1.0f);
+    __m256 rgb = _mm256_setr_ps(color.x, color.y, color.z, 0, color.x, color.y, color.z, 0);
+    float bax = capsule->bx - capsule->ax, bay = capsule->by - capsule->ay;
+    float pay = y - capsule->ay;
+    __m256 ba_x = _mm256_set1_ps(bax), ba_y = _mm256_set1_ps(bay);
+    __m256 pa_y = _mm256_set1_ps(pay), pa_y_ba_y = _mm256_set1_ps(pay * bay);
+    __m256 length2 = _mm256_set1_ps(bax * bax + bay * bay);
+    __m256 pa_x = first_x_avx2(x0, capsule->ax);
+    __m256 offset = _mm256_set1_ps(0.5f + capsule->r);
+    int x = x0;
+    for (; x + 7 <= x1; x += 8, pa_x = _mm256_add_ps(pa_x, _mm256_set1_ps(8.0f))) {
+        __m256 h = _mm256_div_ps(_mm256_add_ps(_mm256_mul_ps(pa_x, ba_x), pa_y_ba_y), length2);
+        h = _mm256_max_ps(_mm256_min_ps(h, one), zero);
+        __m256 dx = _mm256_sub_ps(pa_x, _mm256_mul_ps(ba_x, h)), dy = _mm256_sub_ps(pa_y, _mm256_mul_ps(ba_y, h));
+        __m256 distance = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)));
+        blend_avx2(row + x, coverage_avx2(_mm256_sub_ps(offset, distance)), rgb);
+    }
+    if (x <= x1)
+        capsule_sse2(row, x, x1, y, capsule, color);
+}
+
+#endif
+
+const raster_t raster_list[] = {
+        {"scalar", supported_always, box_scalar<vec4_t>, circle_scalar<vec4_t>, capsule_scalar<vec4_t>,
+         box_scalar<uint32_t>, circle_scalar<uint32_t>, capsule_scalar<uint32_t>},
+#ifdef RASTER_X86
+        {"sse2", supported_sse2, box_sse2<vec4_t>, circle_sse2<vec4_t>, capsule_sse2<vec4_t>,
+         box_sse2<uint32_t>, circle_sse2<uint32_t>, capsule_sse2<uint32_t>},
+        {"avx2", supported_avx2, box_avx2<vec4_t>, circle_avx2<vec4_t>, capsule_avx2<vec4_t>,
+         box_avx2<uint32_t>, circle_avx2<uint32_t>, capsule_avx2<uint32_t>},
+#endif
+};
+
+const int raster_count = sizeof(raster_list) / sizeof(raster_list[0]);
+
+const raster_t *raster_find(const char *name) {
+    for (int i = 0; i < raster_count; ++i)
+        if (strcmp(raster_list[i].name, name) == 0)
+            return &raster_list[i];
+    return NULL;
+}
+
+const raster_t *raster_best(void) {
+    for (int i = raster_count - 1; i > 0; --i)
+        if (raster_list[i].supported())
+            return &raster_list[i];
+    return &raster_list[0];
+}
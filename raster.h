@@ -0,0 +1,68 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <stdint.h>
+
+#include "maths.h"
+
+/* row kernels of the shape routines of graphics.cpp
+ *
+ * a kernel evaluates the signed distance of one shape over the pixels x0..x1
+ * of one row and blends color into row by the coverage, like alphablend();
+ * row points at the pixel x = 0 of the framebuffer row the pixels go to.
+ * the packed kernels do the same to rows of FRAMEBUFFER_BGRA8 pixels, see
+ * raster_pack().
+ * the vector kernels do 4 (sse2) or 8 (avx2) pixels per step and skip the
+ * steps no pixel of which is covered; the results equal the scalar ones up
+ * to rounding.
+ */
+
+/* a box rotated by theta, with its corners rounded by r (0 for none):
+ * half_w and half_h are those of the box without the fillet */
+typedef struct {
+    float cx, cy;
+    float cos_theta, sin_theta;
+    float half_w, half_h;
+    float r;
+} raster_box_t;
+
+typedef struct {
+    float cx, cy;
+    float r;
+} raster_circle_t;
+
+/* the segment from a to b, widened by r */
+typedef struct {
+    float ax, ay;
+    float bx, by;
+    float r;
+} raster_capsule_t;
+
+typedef struct {
+    const char *name;
+    int (*supported)(void);             //by the cpu we run on
+    void (*box)(vec4_t *row, int x0, int x1, float y, const raster_box_t *box, vec3_t color);
+    void (*circle)(vec4_t *row, int x0, int x1, float y, const raster_circle_t *circle, vec3_t color);
+    void (*capsule)(vec4_t *row, int x0, int x1, float y, const raster_capsule_t *capsule, vec3_t color);
+    void (*box_packed)(uint32_t *row, int x0, int x1, float y, const raster_box_t *box, vec3_t color);
+    void (*circle_packed)(uint32_t *row, int x0, int x1, float y, const raster_circle_t *circle, vec3_t color);
+    void (*capsule_packed)(uint32_t *row, int x0, int x1, float y, const raster_capsule_t *capsule, vec3_t color);
+} raster_t;
+
+/* a packed pixel holds b, g, r and a in its bytes from the lowest up, each
+ * channel clamped to [0, 1] and rounded to 1 / 255 */
+uint32_t raster_pack(vec4_t color);
+
+vec4_t raster_unpack(uint32_t pixel);
+
+/* scalar first, then faster ones; the vector kernels only exist on x86 */
+extern const raster_t raster_list[];
+extern const int raster_count;
+
+/* returns NULL if there are no kernels called name */
+const raster_t *raster_find(const char *name);
+
+/* the last entry of raster_list the cpu supports */
+const raster_t *raster_best(void);
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+
+/* small fast random number generator (PCG32, XSH RR variant)
+ *
+ * the same seed yields the same sequence on every platform and build, which
+ * keeps generated mazes and generation benchmarks reproducible. it satisfies
+ * UniformRandomBitGenerator, so it also works with <random> and <algorithm>.
+ */
+class rng_t {
+public:
+    typedef uint32_t result_type;
+
+    explicit rng_t(uint64_t seed = 0) { this->seed(seed); }
+
+    void seed(uint64_t seed) {
+        /* spread nearby seeds apart before they reach the state */
+        state = 0;
+        inc = (splitmix64(seed) << 1) | 1;
+        (*this)();
+        state += splitmix64(seed + 0x9e3779b97f4a7c15ULL);
+        (*this)();
+    }
+
+    uint32_t operator()() {
+        uint64_t old = state;
+        state = old * 6364136223846793005ULL + inc;
+        uint32_t xorshifted = (uint32_t) (((old >> 18) ^ old) >> 27);
+        uint32_t rot = (uint32_t) (old >> 59);
+        return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+    }
+
+    /* uniform within [0, n - 1] without modulo bias (Lemire's method) */
+    uint32_t bounded(uint32_t n) {
+        uint64_t m = (uint64_t) (*this)() * n;
+        uint32_t low = (uint32_t) m;
+        if (low < n) {
+            uint32_t threshold = (0u - n) % n;
+            while (low < threshold) {
+                m = (uint64_t) (*this)() * n;
+                low = (uint32_t) m;
+            }
+        }
+        return (uint32_t) (m >> 32);
+    }
+
+    /* one fair random bit, taken from the best mixed bit of the output */
+    bool coin() { return ((*this)() >> 31) != 0; }
+
+    static constexpr uint32_t min() { return 0; }
+    static constexpr uint32_t max() { return UINT32_MAX; }
+
+    static uint64_t splitmix64(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+private:
+    uint64_t state;
+    uint64_t inc;
+};
+
+#endif
@@ -0,0 +1,175 @@
+#include <cassert>
+
+#include <chrono>
+#include <algorithm>
+
+#include "solvepool.h"
+
+using namespace std;
+
+/* queries taken from the own range at a time; a query takes microseconds,
+ * so this keeps the lock out of the way and still leaves most of a range to
+ * steal */
+#define SOLVE_POOL_GRAIN 8
+
+static int pool_size(int threads) {
+    return threads > 0 ? threads : max(1, (int) thread::hardware_concurrency());
+}
+
+solve_pool_t::solve_pool_t(int thread_count, const solver_t *solver)
+    : solver(solver ? solver : solver_find("bfs")), stats(), workers(pool_size(thread_count)), queries(NULL),
+      walls(NULL), from(NULL), to(NULL), steps(NULL), paths(NULL), generation(0), running(0), stopping(false) {
+    for (int i = 1; i < (int) workers.size(); ++i)
+        threads.push_back(thread(&solve_pool_t::run, this, i));
+}
+
+solve_pool_t::~solve_pool_t() {
+    {
+        lock_guard<mutex> guard(lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (thread &t : threads)
+        t.join();
+}
+
+/* the body of every thread but the caller's: one work() per batch */
+void solve_pool_t::run(int self) {
+    int seen = 0;
+    for (;;) {
+        {
+            unique_lock<mutex> guard(lock);
+            wake.wait(guard, [&] { return stopping || generation != seen; });
+            if (stopping)
+                return;
+            seen = generation;
+        }
+        work(self);
+        {
+            lock_guard<mutex> guard(lock);
+            if (--running == 0)
+                done.notify_one();
+        }
+    }
+}
+
+/* the next queries for thread self, from its own range or stolen */
+bool solve_pool_t::take(int self, int &begin, int &end) {
+    worker_t &me = workers[self];
+    {
+        lock_guard<mutex> guard(me.lock);
+        if (me.begin < me.end) {
+            begin = me.begin;
+            end = min(me.end, begin + SOLVE_POOL_GRAIN);
+            me.begin = end;
+            return true;
+        }
+    }
+    int count = (int) workers.size();
+    for (int k = 1; k < count; ++k) {
+        worker_t &victim = workers[(self + k) % count];
+        int first, last;
+        {
+            lock_guard<mutex> guard(victim.lock);
+            int left = victim.end - victim.begin;
+            if (left <= 0)
+                continue;
+            first = victim.end - (left + 1) / 2;
+            last = victim.end;
+            victim.end = first;
+        }
+        ++me.steals;
+        /* keep what is not solved right away where others can steal it */
+        end = min(last, first + SOLVE_POOL_GRAIN);
+        begin = first;
+        lock_guard<mutex> guard(me.lock);
+        me.begin = end;
+        me.end = last;
+        return true;
+    }
+    return false;
+}
+
+void solve_pool_t::solve_one(worker_t &worker, int i) {
+    const wallmap_t &maze = queries ? *queries[i].walls : *walls;
+    int a = queries ? queries[i].from : from[i];
+    int b = queries ? queries[i].to : to[i];
+    vector<int> &path = paths ? paths[i] : worker.path;
+    long long expanded = 0;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int found = solver->solve(maze, a, b, path, &expanded);
+    double latency = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    steps[i] = found ? (int) path.size() / 2 : -1;
+    worker.failures += !found;
+    worker.expanded += expanded;
+    worker.busy_seconds += latency;
+    worker.max_latency = max(worker.max_latency, latency);
+}
+
+void solve_pool_t::work(int self) {
+    int begin, end;
+    while (take(self, begin, end))
+        for (int i = begin; i < end; ++i)
+            solve_one(workers[self], i);
+}
+
+void solve_pool_t::dispatch(int count, int *steps_out, vector<int> *paths_out) {
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    int thread_count = (int) workers.size();
+    steps = steps_out;
+    paths = paths_out;
+    for (int i = 0; i < thread_count; ++i) {
+        worker_t &worker = workers[i];
+        worker.begin = (int) ((long long) count * i / thread_count);
+        worker.end = (int) ((long long) count * (i + 1) / thread_count);
+        worker.failures = worker.expanded = worker.steals = 0;
+        worker.busy_seconds = worker.max_latency = 0;
+    }
+
+    {
+        lock_guard<mutex> guard(lock);
+        running = thread_count - 1;
+        ++generation;
+    }
+    wake.notify_all();
+    work(0);
+    {
+        unique_lock<mutex> guard(lock);
+        done.wait(guard, [&] { return running == 0; });
+    }
+
+    stats = solve_stats_t();
+    stats.queries = count;
+    for (const worker_t &worker : workers) {
+        stats.failures += worker.failures;
+        stats.expanded += worker.expanded;
+        stats.steals += worker.steals;
+        stats.busy_seconds += worker.busy_seconds;
+        stats.max_latency = max(stats.max_latency, worker.max_latency);
+    }
+    stats.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    if (count > 0)
+        stats.mean_latency = stats.busy_seconds / count;
+    if (stats.seconds > 0)
+        stats.queries_per_second = count / stats.seconds;
+}
+
+void solve_pool_t::solve(const solve_query_t *batch, int count, int *steps_out, vector<int> *paths_out) {
+    assert(count >= 0);
+    queries = batch;
+    dispatch(count, steps_out, paths_out);
+    queries = NULL;
+}
+
+void solve_pool_t::solve(const wallmap_t &maze, const int *from_cells, const int *to_cells, int count,
+                         int *steps_out, vector<int> *paths_out) {
+    assert(count >= 0);
+    walls = &maze;
+    from = from_cells;
+    to = to_cells;
+    dispatch(count, steps_out, paths_out);
+    walls = NULL;
+    from = to = NULL;
+}
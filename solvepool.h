@@ -0,0 +1,99 @@
+#ifndef SOLVEPOOL_H
+#define SOLVEPOOL_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "wallmap.h"
+#include "solver.h"
+
+/* one query of a batch: cell from to cell to of walls */
+typedef struct {
+    const wallmap_t *walls;
+    int from;
+    int to;
+} solve_query_t;
+
+/* counters of one batch */
+typedef struct {
+    long long queries;
+    long long failures;                 //queries without a path
+    long long expanded;                 //summed over the queries, see solver_t
+    long long steals;                   //ranges of queries taken from another thread
+    double seconds;                     //wall clock from the call to its return
+    double busy_seconds;                //summed over the threads, solving only
+    double mean_latency;                //seconds per query
+    double max_latency;
+    double queries_per_second;
+} solve_stats_t;
+
+/* batch solver on a work-stealing thread pool
+ *
+ * the threads are started once and wait between batches; the calling thread
+ * works as one of them. a batch is cut into one range of queries per thread,
+ * each thread takes a few queries at a time from the front of its own range
+ * and, once that is empty, takes the back half of the range of another
+ * thread, so a few slow queries do not hold up the rest of the batch.
+ *
+ * results go into buffers allocated by the caller: steps[i] is the length
+ * of the path of query i, -1 if there is none, and if paths is not NULL,
+ * paths[i] receives the path itself like solver_t. a vector that already
+ * has the capacity is not reallocated. a batch of mazes is a batch of
+ * queries on different walls.
+ *
+ * solve() is not reentrant: one batch at a time per pool.
+ */
+class solve_pool_t {
+public:
+    /* threads <= 0 uses every hardware thread; solver NULL is bfs */
+    explicit solve_pool_t(int threads = 0, const solver_t *solver = NULL);
+    ~solve_pool_t();
+
+    void solve(const solve_query_t *queries, int count, int *steps, std::vector<int> *paths = NULL);
+
+    /* count queries on one maze, from cell from[i] to cell to[i] */
+    void solve(const wallmap_t &walls, const int *from, const int *to, int count, int *steps,
+               std::vector<int> *paths = NULL);
+
+    int thread_count() const { return (int) threads.size() + 1; }
+
+    const solver_t *solver;
+    solve_stats_t stats;                //of the last batch
+
+private:
+    typedef struct {
+        std::mutex lock;                //guards begin and end
+        int begin, end;                 //the queries left to this thread
+        std::vector<int> path;          //when the caller wants no paths
+        long long failures, expanded, steals;
+        double busy_seconds, max_latency;
+    } worker_t;
+
+    void run(int self);
+    void work(int self);
+    bool take(int self, int &begin, int &end);
+    void solve_one(worker_t &worker, int i);
+    void dispatch(int count, int *steps, std::vector<int> *paths);
+
+    std::vector<worker_t> workers;
+    std::vector<std::thread> threads;
+
+    /* the current batch: queries, or walls with from and to */
+    const solve_query_t *queries;
+    const wallmap_t *walls;
+    const int *from;
+    const int *to;
+    int *steps;
+    std::vector<int> *paths;
+
+    std::mutex lock;                    //guards generation, running and stopping
+    std::condition_variable wake;
+    std::condition_variable done;
+    int generation;                     //batches started so far
+    int running;                        //threads still on the current batch
+    bool stopping;
+};
+
+#endif
@@ -0,0 +1,328 @@
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+#include <algorithm>
+
+#include "solver.h"
+#include "wave.h"
+#include "macro.h"
+
+using namespace std;
+
+/* a stack level: bits 0-2 the next direction to try, 4 once every one was,
+ * bits 3-4 the direction taken from the level below */
+#define LEVEL(in_dir, next_dir) ((unsigned char) ((in_dir) << 3 | (next_dir)))
+#define LEVEL_IN(level) (((level) >> 3) & 3)
+#define LEVEL_NEXT(level) ((level) & 7)
+
+stack_solver_t::stack_solver_t() : max_depth(0), expanded(0) {}
+
+/* returns the depth of the exit on the stack, -1 if it can not be reached */
+int stack_solver_t::search(const wallmap_t &walls, int start, int exit) {
+    size_t maze_size = (size_t) walls.width * walls.height;
+    if (stack.size() < maze_size) {
+        /* a path never visits a cell twice, so it is at most maze_size levels deep */
+        stack.assign(maze_size, 0);
+        visited.assign((maze_size + 63) / 64, 0);
+    } else {
+        fill(visited.begin(), visited.begin() + (maze_size + 63) / 64, 0);
+    }
+
+    int depth = 0;
+    int cur = start;
+    max_depth = 0;
+    expanded = 1;
+    stack[0] = LEVEL(0, 0);
+    wallmap_set_bit(visited.data(), cur);
+    while (cur != exit) {
+        unsigned char level = stack[depth];
+        int dir = LEVEL_NEXT(level);
+        if (dir == 4) {
+            /* every way out is tried, go back down */
+            if (depth == 0)
+                return -1;
+            cur = walls.neighbour(cur, LEVEL_IN(level) ^ 1);
+            --depth;
+            continue;
+        }
+        stack[depth] = level + 1;
+        if (walls.wall(cur, dir))
+            continue;
+        int next = walls.neighbour(cur, dir);
+        if (wallmap_bit(visited.data(), next))
+            continue;
+        wallmap_set_bit(visited.data(), next);
+        stack[++depth] = LEVEL(dir, 0);
+        ++expanded;
+        if (depth > max_depth)
+            max_depth = depth;
+        cur = next;
+    }
+    return depth;
+}
+
+/* the positions of the path found by the last search, from start */
+void stack_solver_t::trace(const wallmap_t &walls, int start, int depth, vector<int> &path) const {
+    int rmw = walls.width * 2 + 1;
+    int at = (start / walls.width * 2 + 1) * rmw + start % walls.width * 2 + 1;
+    path.push_back(at);
+    for (int i = 1; i <= depth; ++i) {
+        int dir = LEVEL_IN(stack[i]);
+        path.push_back(at + offr[dir] * rmw + offc[dir]);
+        at += 2 * (offr[dir] * rmw + offc[dir]);
+        path.push_back(at);
+    }
+}
+
+int stack_solver_t::solve(const maze_t &maze, int pos, vector<int> &hint) {
+    const wallmap_t &walls = maze.mazemap;
+    int rmw = walls.width * 2 + 1;
+    int x = pos % rmw;
+    int y = pos / rmw;
+
+    hint.clear();
+    if (walls[pos])
+        return 0;
+    /* a gap starts from the cell on its left or below it, and drops that
+     * cell again if the path turns back through the gap */
+    int start = (x & 1) ? (y - 1) / 2 * walls.width + x / 2 : y / 2 * walls.width + (x - 1) / 2;
+    int depth = search(walls, start, walls.width - 1);
+    if (depth < 0)
+        return 0;
+
+    hint.reserve(depth * 2 + 2);
+    trace(walls, start, depth, hint);
+    if (hint[0] != pos) {
+        if (hint.size() > 1 && hint[1] == pos)
+            hint.erase(hint.begin());
+        else
+            hint.insert(hint.begin(), pos);
+    }
+    return 1;
+}
+
+int stack_solver_t::solve(const wallmap_t &walls, int from, int to, vector<int> &path) {
+    path.clear();
+    int depth = search(walls, from, to);
+    if (depth < 0)
+        return 0;
+    path.reserve(depth * 2 + 1);
+    trace(walls, from, depth, path);
+    return 1;
+}
+
+size_t stack_solver_t::bytes() const {
+    return stack.capacity() + visited.capacity() * sizeof(uint64_t);
+}
+
+/* point to point solvers */
+
+static int cell_position(const wallmap_t &walls, int cell) {
+    return (cell / walls.width * 2 + 1) * (walls.width * 2 + 1) + cell % walls.width * 2 + 1;
+}
+
+/* appends the positions from cell from to cell to, walking back over
+ * in_dir, the direction every cell was reached by */
+static void trace_back(const wallmap_t &walls, int from, int to, const vector<char> &in_dir, vector<int> &path) {
+    int rmw = walls.width * 2 + 1;
+    size_t first = path.size();
+    for (int cell = to; cell != from; cell = walls.neighbour(cell, in_dir[cell] ^ 1)) {
+        int at = cell_position(walls, cell);
+        path.push_back(at);
+        path.push_back(at - offr[(int) in_dir[cell]] * rmw - offc[(int) in_dir[cell]]);
+    }
+    path.push_back(cell_position(walls, from));
+    reverse(path.begin() + first, path.end());
+}
+
+static int solve_bfs(const wallmap_t &walls, int from, int to, vector<int> &path, long long *expanded) {
+    int maze_size = walls.width * walls.height;
+    vector<char> in_dir(maze_size, -1);
+    vector<int> queue;
+    queue.reserve(maze_size);
+
+    path.clear();
+    *expanded = 0;
+    in_dir[from] = 4;                   //visited, any value but -1
+    queue.push_back(from);
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int cur = queue[head];
+        ++*expanded;
+        if (cur == to) {
+            trace_back(walls, from, to, in_dir, path);
+            return 1;
+        }
+        for (int dir = 0; dir < 4; ++dir) {
+            if (walls.wall(cur, dir))
+                continue;
+            int next = walls.neighbour(cur, dir);
+            if (in_dir[next] >= 0)
+                continue;
+            in_dir[next] = (char) dir;
+            queue.push_back(next);
+        }
+    }
+    return 0;
+}
+
+int heuristic_manhattan(const wallmap_t &walls, int cell, int goal) {
+    return abs(cell % walls.width - goal % walls.width) + abs(cell / walls.width - goal / walls.width);
+}
+
+int heuristic_zero(const wallmap_t &walls, int cell, int goal) {
+    UNUSED_VAR(walls);
+    UNUSED_VAR(cell);
+    UNUSED_VAR(goal);
+    return 0;
+}
+
+int solver_astar(const wallmap_t &walls, int from, int to, heuristic_t heuristic,
+                 vector<int> &path, long long *expanded) {
+    int maze_size = walls.width * walls.height;
+    vector<int> cost(maze_size, -1);
+    vector<char> in_dir(maze_size, -1);
+    vector<vector<int>> open;           //open[f], newest last
+
+    path.clear();
+    *expanded = 0;
+    cost[from] = 0;
+    in_dir[from] = 4;
+    open.resize(heuristic(walls, from, to) + 1);
+    open.back().push_back(from);
+    /* f never decreases along a path, so the buckets are taken in order once */
+    for (size_t f = 0; f < open.size(); ++f) {
+        while (!open[f].empty()) {
+            int cur = open[f].back();
+            open[f].pop_back();
+            if (cost[cur] + heuristic(walls, cur, to) != (int) f)
+                continue;               //queued again since with a lower cost
+            ++*expanded;
+            if (cur == to) {
+                trace_back(walls, from, to, in_dir, path);
+                return 1;
+            }
+            for (int dir = 0; dir < 4; ++dir) {
+                if (walls.wall(cur, dir))
+                    continue;
+                int next = walls.neighbour(cur, dir);
+                if (cost[next] >= 0 && cost[next] <= cost[cur] + 1)
+                    continue;
+                cost[next] = cost[cur] + 1;
+                in_dir[next] = (char) dir;
+                size_t next_f = cost[next] + heuristic(walls, next, to);
+                if (next_f >= open.size())
+                    open.resize(next_f + 1);
+                open[next_f].push_back(next);
+            }
+        }
+    }
+    return 0;
+}
+
+static int solve_astar(const wallmap_t &walls, int from, int to, vector<int> &path, long long *expanded) {
+    return solver_astar(walls, from, to, heuristic_manhattan, path, expanded);
+}
+
+static int solve_dijkstra(const wallmap_t &walls, int from, int to, vector<int> &path, long long *expanded) {
+    return solver_astar(walls, from, to, heuristic_zero, path, expanded);
+}
+
+/* breadth-first from both ends, a whole level of the smaller frontier at a
+ * time; once the two sides touch, the rest of that level is still looked at
+ * so that the shortest of the meetings wins */
+static int solve_bidirectional(const wallmap_t &walls, int from, int to, vector<int> &path, long long *expanded) {
+    int maze_size = walls.width * walls.height;
+    vector<char> side(maze_size, 0);    //1 reached from from, 2 reached from to
+    vector<char> in_dir(maze_size, -1);
+    vector<int> cost(maze_size, 0);
+    vector<int> frontier[2] = {vector<int>(1, from), vector<int>(1, to)};
+    vector<int> next_frontier;
+    int best = -1, meet_from = -1, meet_to = -1;
+    char meet_dir = 0;                  //from meet_from to meet_to
+
+    path.clear();
+    *expanded = 0;
+    side[from] = 1;
+    side[to] = 2;
+    if (from == to) {
+        ++*expanded;
+        path.push_back(cell_position(walls, from));
+        return 1;
+    }
+    while (best < 0 && !frontier[0].empty() && !frontier[1].empty()) {
+        int s = frontier[0].size() <= frontier[1].size() ? 0 : 1;
+        next_frontier.clear();
+        for (int cur : frontier[s]) {
+            ++*expanded;
+            for (int dir = 0; dir < 4; ++dir) {
+                if (walls.wall(cur, dir))
+                    continue;
+                int next = walls.neighbour(cur, dir);
+                if (side[next] == s + 1)
+                    continue;
+                if (side[next] != 0) {
+                    int length = cost[cur] + 1 + cost[next];
+                    if (best < 0 || length < best) {
+                        best = length;
+                        meet_from = s == 0 ? cur : next;
+                        meet_to = s == 0 ? next : cur;
+                        meet_dir = (char) (s == 0 ? dir : dir ^ 1);
+                    }
+                    continue;
+                }
+                side[next] = (char) (s + 1);
+                cost[next] = cost[cur] + 1;
+                in_dir[next] = (char) dir;
+                next_frontier.push_back(next);
+            }
+        }
+        frontier[s].swap(next_frontier);
+    }
+    if (best < 0)
+        return 0;
+
+    /* from side up to the meeting, then down the to side */
+    int rmw = walls.width * 2 + 1;
+    path.reserve(best * 2 + 1);
+    trace_back(walls, from, meet_from, in_dir, path);
+    path.push_back(cell_position(walls, meet_from) + offr[(int) meet_dir] * rmw + offc[(int) meet_dir]);
+    for (int cell = meet_to; cell != to; cell = walls.neighbour(cell, in_dir[cell] ^ 1)) {
+        path.push_back(cell_position(walls, cell));
+        path.push_back(cell_position(walls, cell) - offr[(int) in_dir[cell]] * rmw - offc[(int) in_dir[cell]]);
+    }
+    path.push_back(cell_position(walls, to));
+    return 1;
+}
+
+static int solve_dfs(const wallmap_t &walls, int from, int to, vector<int> &path, long long *expanded) {
+    stack_solver_t solver;
+    int found = solver.solve(walls, from, to, path);
+    *expanded = solver.expanded;
+    return found;
+}
+
+static int solve_wave(const wallmap_t &walls, int from, int to, vector<int> &path, long long *expanded) {
+    wave_solver_t solver;
+    int found = solver.solve(walls, from, to, path);
+    *expanded = solver.expanded;
+    return found;
+}
+
+const solver_t solver_list[] = {
+        {"bfs",           solve_bfs},
+        {"astar",         solve_astar},
+        {"dijkstra",      solve_dijkstra},
+        {"bidirectional", solve_bidirectional},
+        {"dfs",           solve_dfs},
+        {"wave",          solve_wave}
+};
+
+const int solver_count = ARRAY_SIZE(solver_list);
+
+const solver_t *solver_find(const char *name) {
+    for (int i = 0; i < solver_count; ++i)
+        if (strcmp(solver_list[i].name, name) == 0)
+            return &solver_list[i];
+    return NULL;
+}
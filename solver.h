@@ -0,0 +1,74 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <cstddef>
+#include <vector>
+
+#include "maze.h"
+
+/* depth-first solver for mazes too big for the distance field
+ *
+ * maze_t::solve() reads the path off a field of about 5 bytes per cell.
+ * stack_solver_t needs neither that field nor the call stack: it walks
+ * depth-first with an explicit stack of one byte per level (the direction
+ * that led into the cell and the next direction to try) and a visited
+ * bitmap. both are sized once for the maze and never grow during a search,
+ * so a 10k x 10k maze takes about 112 MB whatever thread it runs on.
+ */
+class stack_solver_t {
+public:
+    stack_solver_t();
+
+    /* fills hint with the path from pos, a cell or a gap of the expanded
+     * grid, to the exit like maze_t::solve(); returns 0 if there is none */
+    int solve(const maze_t &maze, int pos, std::vector<int> &hint);
+
+    /* the same from cell from to cell to, see solver_t */
+    int solve(const wallmap_t &walls, int from, int to, std::vector<int> &path);
+
+    /* memory held for the largest maze solved so far */
+    size_t bytes() const;
+
+    int max_depth;                      //deepest level reached by the last solve()
+    long long expanded;                 //cells pushed by the last solve()
+
+private:
+    int search(const wallmap_t &walls, int start, int exit);
+    void trace(const wallmap_t &walls, int start, int depth, std::vector<int> &path) const;
+
+    std::vector<unsigned char> stack;
+    std::vector<uint64_t> visited;
+};
+
+/* point to point solvers
+ *
+ * every solver fills path with the expanded positions from cell from to
+ * cell to, both included like maze_t::hint, and returns 0 if there is no
+ * path. expanded is set to the number of cells whose neighbours were looked
+ * at. all of them give the shortest path, also on mazes with loops, except
+ * dfs, which gives the first path it finds (the only one on a perfect maze).
+ */
+typedef struct {
+    const char *name;
+    int (*solve)(const wallmap_t &walls, int from, int to, std::vector<int> &path, long long *expanded);
+} solver_t;
+
+extern const solver_t solver_list[];
+extern const int solver_count;
+
+/* returns NULL if there is no solver called name */
+const solver_t *solver_find(const char *name);
+
+/* a lower bound of the steps from cell to goal; it must never drop by more
+ * than one per step, which holds for every distance on the grid */
+typedef int (*heuristic_t)(const wallmap_t &walls, int cell, int goal);
+
+int heuristic_manhattan(const wallmap_t &walls, int cell, int goal);
+int heuristic_zero(const wallmap_t &walls, int cell, int goal);
+
+/* A* with an open list of one bucket per f = cost + heuristic, the costs
+ * being small integers; heuristic_zero turns it into Dijkstra */
+int solver_astar(const wallmap_t &walls, int from, int to, heuristic_t heuristic,
+                 std::vector<int> &path, long long *expanded);
+
+#endif
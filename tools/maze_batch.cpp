@@ -0,0 +1,372 @@
+/* maze_batch: generates (and optionally solves) mazes without the game window
+ *
+ * maze_batch [options]
+ *     -w, --width N          maze width in cells                 (50)
+ *     -h, --height N         maze height in cells                (50)
+ *     -n, --count N          number of mazes                     (1)
+ *     -s, --seed N           first seed, maze i uses seed + i    (0)
+ *     -a, --algorithm NAME   generator, see generator_list       (prim)
+ *     -t, --threads N        worker threads, 0 for all           (0)
+ *     -T, --tile N           generate each maze in N x N tiles on all the
+ *                            threads instead of one maze per thread
+ *     -o, --output DIR       write DIR/maze_<seed>.maze for every maze, see mazefile.h
+ *     --text                 write DIR/maze_<seed>.txt as text instead
+ *     --stream               write every maze to DIR row by row as Eller's algorithm
+ *                            makes it, in O(width) memory, so mazes far larger than
+ *                            fit in memory can be made; needs -a eller and -o and
+ *                            takes none of -T, --solve, -q, -p
+ *     --solve                solve every maze from the top-left cell to the exit,
+ *                            depth-first with a bounded stack, see solver.h
+ *     -q, --queries N        N random cell to cell distances per maze, see pathindex.h
+ *     -p, --paths N          N random cell to cell paths per maze; the mazes are
+ *                            made in rounds of one per thread, then the paths
+ *                            of a round are solved together on a work-stealing
+ *                            pool of all the threads, see solvepool.h
+ *     --solver NAME          solver of the paths, see solver_list (bfs)
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+#include "eller.h"
+#include "generator_impl.h"
+#include "maze.h"
+#include "mazefile.h"
+#include "pathindex.h"
+#include "solver.h"
+#include "solvepool.h"
+
+using namespace std;
+
+typedef struct {
+    int width = 50;
+    int height = 50;
+    int count = 1;
+    uint64_t seed = 0;
+    const generator_t *generator = &generator_list[0];
+    int threads = 0;
+    int tile = 0;
+    int queries = 0;
+    int paths = 0;
+    const solver_t *solver = NULL;
+    const char *output = NULL;
+    bool solve = false;
+    bool text = false;
+    bool stream = false;
+} options_t;
+
+typedef struct {
+    const options_t *options;
+    atomic<int> next_maze;
+    int end_maze;                       //of the round
+    atomic<int> failures;
+    atomic<long long> path_cells;
+    atomic<long long> query_steps;
+    atomic<long long> solver_bytes;     //the largest footprint of any worker's solver
+    atomic<long long> maze_bytes;       //the largest walls and field of any worker's maze
+    atomic<long long> path_steps;
+    /* of the pool, in nanoseconds */
+    atomic<long long> pool_nanoseconds; //wall clock of the batches
+    atomic<long long> busy_nanoseconds;
+    atomic<long long> max_latency_nanoseconds;
+    atomic<long long> steals;
+} batch_t;
+
+/* what a thread keeps from maze to maze */
+struct worker_t {
+    maze_t maze;
+    path_index_t index;
+    stack_solver_t solver;
+    vector<int> hint;
+    int current = -1;                   //the maze of the round, -1 if none
+
+    worker_t(int width, int height) : maze(width, height) {}
+};
+
+/* the most memory the process has held, -1 where that is not known */
+static double peak_megabytes(void) {
+#ifdef _WIN32
+    return -1;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return -1;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1048576.0;     //bytes
+#else
+    return usage.ru_maxrss / 1024.0;        //kilobytes
+#endif
+#endif
+}
+
+static void max_into(atomic<long long> &max_value, long long value) {
+    for (long long prev = max_value; prev < value;)
+        if (max_value.compare_exchange_weak(prev, value))
+            break;
+}
+
+static void usage(void) {
+    printf("usage: maze_batch [-w width] [-h height] [-n count] [-s seed] [-a algorithm]\n"
+           "                  [-t threads] [-T tile] [-o dir] [--text] [--stream] [--solve] [-q queries]\n"
+           "                  [-p paths] [--solver name]\n"
+           "algorithms:");
+    for (int i = 0; i < generator_count; ++i)
+        printf(" %s", generator_list[i].name);
+    printf("\nsolvers:");
+    for (int i = 0; i < solver_count; ++i)
+        printf(" %s", solver_list[i].name);
+    printf("\n");
+}
+
+static int parse_options(int argc, char *argv[], options_t *options) {
+    for (int i = 1; i < argc; ++i) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--solve") == 0) {
+            options->solve = true;
+            continue;
+        }
+        if (strcmp(arg, "--text") == 0) {
+            options->text = true;
+            continue;
+        }
+        if (strcmp(arg, "--stream") == 0) {
+            options->stream = true;
+            continue;
+        }
+        if (value == NULL)
+            return 0;
+        ++i;
+        if (strcmp(arg, "-w") == 0 || strcmp(arg, "--width") == 0) {
+            options->width = atoi(value);
+        } else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--height") == 0) {
+            options->height = atoi(value);
+        } else if (strcmp(arg, "-n") == 0 || strcmp(arg, "--count") == 0) {
+            options->count = atoi(value);
+        } else if (strcmp(arg, "-s") == 0 || strcmp(arg, "--seed") == 0) {
+            options->seed = strtoull(value, NULL, 10);
+        } else if (strcmp(arg, "-a") == 0 || strcmp(arg, "--algorithm") == 0) {
+            options->generator = generator_find(value);
+            if (options->generator == NULL)
+                return 0;
+        } else if (strcmp(arg, "-t") == 0 || strcmp(arg, "--threads") == 0) {
+            options->threads = atoi(value);
+        } else if (strcmp(arg, "-T") == 0 || strcmp(arg, "--tile") == 0) {
+            options->tile = atoi(value);
+        } else if (strcmp(arg, "-q") == 0 || strcmp(arg, "--queries") == 0) {
+            options->queries = atoi(value);
+        } else if (strcmp(arg, "-p") == 0 || strcmp(arg, "--paths") == 0) {
+            options->paths = atoi(value);
+        } else if (strcmp(arg, "--solver") == 0) {
+            options->solver = solver_find(value);
+            if (options->solver == NULL)
+                return 0;
+        } else if (strcmp(arg, "-o") == 0 || strcmp(arg, "--output") == 0) {
+            options->output = value;
+        } else {
+            return 0;
+        }
+    }
+    if (options->stream && (options->output == NULL || strcmp(options->generator->name, "eller") != 0 ||
+                            options->tile > 0 || options->solve || options->queries > 0 || options->paths > 0))
+        return 0;
+    return options->width > 0 && options->height > 0 && options->count > 0 && options->threads >= 0 &&
+           options->queries >= 0 && options->paths >= 0;
+}
+
+/* writes the maze of seed to DIR as Eller's algorithm makes it, without a
+ * maze_t; the file is the same as mazefile_save() of the generated maze */
+static int stream_maze(const options_t *options, uint64_t seed) {
+    rng_t rand_num(seed);
+    uint64_t row_seed = eller_seed(rand_num);
+    string filename = string(options->output) + "/maze_" + to_string(seed);
+    if (options->text)
+        return eller_write_file((filename + ".txt").c_str(), options->width, options->height, row_seed);
+    FILE *file = mazefile_begin((filename + ".maze").c_str(), options->width, options->height, seed, "eller");
+    if (file == NULL)
+        return 0;
+    eller_generate(options->width, options->height, row_seed, mazefile_write_row, file);
+    return mazefile_end(file);
+}
+
+/* the mazes of the round, one at a time until there are none left, or only
+ * one if their paths are wanted: those are solved after the round */
+static void run_batch(batch_t *batch, worker_t *worker, int tile_threads) {
+    const options_t *options = batch->options;
+    maze_t &maze = worker->maze;
+    maze.generator = options->generator;
+    /* the field is only needed by the queries */
+    maze.keep_field = options->queries > 0;
+    worker->current = -1;
+    for (int i = batch->next_maze++; i < batch->end_maze; i = batch->next_maze++) {
+        uint64_t seed = options->seed + (uint64_t) i;
+        if (options->stream) {
+            if (!stream_maze(options, seed))
+                ++batch->failures;
+            continue;
+        }
+        if (options->tile > 0) {
+            maze.seed = seed;
+            generator_run_tiled(maze.generator, maze.mazemap, seed, tile_threads, options->tile);
+            if (maze.keep_field)
+                maze.update_field();
+        } else {
+            maze.refresh(seed);
+        }
+        if (options->solve) {
+            int rmw = maze.width * 2 + 1;
+            if (!worker->solver.solve(maze, (maze.height * 2 - 1) * rmw + 1, worker->hint))
+                ++batch->failures;
+            batch->path_cells += (long long) worker->hint.size();
+            max_into(batch->solver_bytes, (long long) worker->solver.bytes());
+            max_into(batch->maze_bytes, (long long) (maze.mazemap.bytes() + maze.distance.capacity() * sizeof(int) +
+                                                     maze.toward_exit.capacity()));
+        }
+        if (options->queries > 0) {
+            rng_t rand_num(seed);
+            long long steps = 0;
+            int maze_size = maze.width * maze.height;
+            worker->index.build(maze);
+            for (int q = 0; q < options->queries; ++q) {
+                int d = worker->index.distance(rand_num.bounded(maze_size), rand_num.bounded(maze_size));
+                if (d < 0)
+                    ++batch->failures;
+                steps += d;
+            }
+            batch->query_steps += steps;
+        }
+        if (options->output) {
+            string filename = string(options->output) + "/maze_" + to_string(seed);
+            int saved = options->text ? mazefile_save_text(maze.mazemap, (filename + ".txt").c_str())
+                                      : mazefile_save(maze, (filename + ".maze").c_str());
+            if (!saved)
+                ++batch->failures;
+        }
+        worker->current = i;
+        if (options->paths > 0)
+            break;
+    }
+}
+
+/* the paths of every maze of the round, as one batch on pool */
+static void solve_paths(batch_t *batch, vector<worker_t> &workers, solve_pool_t &pool,
+                        vector<solve_query_t> &queries, vector<int> &steps) {
+    const options_t *options = batch->options;
+    queries.clear();
+    for (worker_t &worker : workers) {
+        if (worker.current < 0)
+            continue;
+        rng_t rand_num(~(options->seed + (uint64_t) worker.current));
+        int maze_size = worker.maze.width * worker.maze.height;
+        for (int q = 0; q < options->paths; ++q) {
+            int from = (int) rand_num.bounded(maze_size);
+            int to = (int) rand_num.bounded(maze_size);
+            queries.push_back(solve_query_t{&worker.maze.mazemap, from, to});
+        }
+    }
+    steps.resize(queries.size());
+    pool.solve(queries.data(), (int) queries.size(), steps.data());
+
+    const solve_stats_t &stats = pool.stats;
+    long long path_steps = 0;
+    for (int step : steps)
+        path_steps += step;
+    batch->failures += (int) stats.failures;
+    batch->path_steps += path_steps;
+    batch->pool_nanoseconds += (long long) (stats.seconds * 1e9);
+    batch->busy_nanoseconds += (long long) (stats.busy_seconds * 1e9);
+    batch->steals += stats.steals;
+    max_into(batch->max_latency_nanoseconds, (long long) (stats.max_latency * 1e9));
+}
+
+int main(int argc, char *argv[]) {
+    options_t options;
+    batch_t batch;
+
+    if (!parse_options(argc, argv, &options)) {
+        usage();
+        return 1;
+    }
+    int threads = options.threads > 0 ? options.threads : max(1, (int) thread::hardware_concurrency());
+    batch.options = &options;
+    batch.next_maze = 0;
+    batch.failures = 0;
+    batch.path_cells = 0;
+    batch.query_steps = 0;
+    batch.solver_bytes = 0;
+    batch.maze_bytes = 0;
+    batch.path_steps = 0;
+    batch.pool_nanoseconds = 0;
+    batch.busy_nanoseconds = 0;
+    batch.max_latency_nanoseconds = 0;
+    batch.steals = 0;
+
+    /* with -T one maze at a time, every thread on its tiles */
+    int tile_threads = options.tile > 0 ? threads : 1;
+    int worker_count = options.tile > 0 ? 1 : min(threads, options.count);
+    vector<worker_t> workers;
+    workers.reserve(worker_count);
+    /* streamed mazes never are in a maze_t */
+    for (int i = 0; i < worker_count; ++i)
+        workers.emplace_back(options.stream ? 1 : options.width, options.stream ? 1 : options.height);
+    solve_pool_t pool(options.paths > 0 ? threads : 1, options.solver);
+    vector<solve_query_t> queries;
+    vector<int> steps;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    /* without paths all the mazes are one round */
+    int round = options.paths > 0 ? worker_count : options.count;
+    for (int first = 0; first < options.count; first += round) {
+        batch.next_maze = first;
+        batch.end_maze = min(options.count, first + round);
+        vector<thread> running;
+        for (int i = 1; i < worker_count; ++i)
+            running.push_back(thread(run_batch, &batch, &workers[i], tile_threads));
+        run_batch(&batch, &workers[0], tile_threads);
+        for (thread &worker : running)
+            worker.join();
+        if (options.paths > 0)
+            solve_paths(&batch, workers, pool, queries, steps);
+    }
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+
+    double seconds = elapsed.count();
+    double cells = (double) options.width * options.height * options.count;
+    printf("%d mazes of %dx%d (%s) on %d threads in %.3f s\n", options.count, options.width, options.height,
+           options.generator->name, threads, seconds);
+    printf("%.2f mazes/s, %.0f cells/s\n", options.count / seconds, cells / seconds);
+    if (options.solve)
+        printf("average path %.1f expanded cells, solver stack and bitmap %.1f MB per thread\n",
+               (double) batch.path_cells / options.count, batch.solver_bytes / 1048576.0);
+    /* the walls, a field only if asked for and the solver should be all a
+     * solving thread holds; compare with what the process really peaked at */
+    if (options.solve && peak_megabytes() >= 0)
+        printf("peak resident %.1f MB, walls and field %.1f MB per thread\n", peak_megabytes(),
+               batch.maze_bytes / 1048576.0);
+    if (options.queries > 0)
+        printf("average distance %.1f steps over %lld queries\n",
+               (double) batch.query_steps / ((long long) options.queries * options.count),
+               (long long) options.queries * options.count);
+    if (options.paths > 0) {
+        long long paths = (long long) options.paths * options.count;
+        printf("average path %.1f steps over %lld paths (%s), %.0f paths/s on %d threads, latency %.2f us mean, "
+               "%.2f us max, %lld steals\n",
+               (double) batch.path_steps / paths, paths, options.solver ? options.solver->name : "bfs",
+               paths / (batch.pool_nanoseconds * 1e-9), pool.thread_count(), batch.busy_nanoseconds * 1e-3 / paths,
+               batch.max_latency_nanoseconds * 1e-3, (long long) batch.steals);
+    }
+    if (batch.failures > 0)
+        printf("%d failures\n", (int) batch.failures);
+    return batch.failures > 0;
+}
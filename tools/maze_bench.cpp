@@ -0,0 +1,182 @@
+/* maze_bench: compares the solvers of solver_list on every difficulty preset
+ *
+ * maze_bench [options]
+ *     -n, --count N          mazes per preset                                 (100)
+ *     -q, --queries N        queries per maze: the game's hint from the
+ *                            top-left cell to the exit, then random cell pairs (10)
+ *     -s, --seed N           first seed, maze i uses seed + i                 (0)
+ *     -a, --algorithm NAME   generator, see generator_list                    (prim)
+ *     -b, --braid P          knock down one more wall of each cell with
+ *                            probability P, which adds loops                  (0)
+ *
+ * every solver but dfs must find paths of the same length; the exit status
+ * is 1 if they do not. the junction row searches the corridor-compressed
+ * graph of junction.h, built once per maze outside the timings; its build
+ * time and size are printed below it.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <vector>
+#include <chrono>
+
+#include "gamelogic.h"
+#include "junction.h"
+#include "macro.h"
+#include "maze.h"
+#include "solver.h"
+
+using namespace std;
+
+typedef struct {
+    int count = 100;
+    int queries = 10;
+    uint64_t seed = 0;
+    const generator_t *generator = &generator_list[0];
+    double braid = 0;
+} options_t;
+
+typedef struct {
+    long long expanded;
+    long long steps;
+    double seconds;
+} result_t;
+
+static void usage(void) {
+    printf("usage: maze_bench [-n count] [-q queries] [-s seed] [-a algorithm] [-b braid]\n"
+           "algorithms:");
+    for (int i = 0; i < generator_count; ++i)
+        printf(" %s", generator_list[i].name);
+    printf("\nsolvers:");
+    for (int i = 0; i < solver_count; ++i)
+        printf(" %s", solver_list[i].name);
+    printf("\n");
+}
+
+static int parse_options(int argc, char *argv[], options_t *options) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const char *arg = argv[i];
+        const char *value = argv[i + 1];
+        if (strcmp(arg, "-n") == 0 || strcmp(arg, "--count") == 0) {
+            options->count = atoi(value);
+        } else if (strcmp(arg, "-q") == 0 || strcmp(arg, "--queries") == 0) {
+            options->queries = atoi(value);
+        } else if (strcmp(arg, "-s") == 0 || strcmp(arg, "--seed") == 0) {
+            options->seed = strtoull(value, NULL, 10);
+        } else if (strcmp(arg, "-a") == 0 || strcmp(arg, "--algorithm") == 0) {
+            options->generator = generator_find(value);
+            if (options->generator == NULL)
+                return 0;
+        } else if (strcmp(arg, "-b") == 0 || strcmp(arg, "--braid") == 0) {
+            options->braid = atof(value);
+        } else {
+            return 0;
+        }
+    }
+    return argc % 2 == 1 && options->count > 0 && options->queries > 0 && options->braid >= 0;
+}
+
+/* opens a random closed inner wall of each cell with probability braid */
+static void braid_maze(wallmap_t &walls, double braid, rng_t &rand_num) {
+    uint32_t threshold = (uint32_t) (braid >= 1 ? 0xffffffffu : braid * 4294967296.0);
+    for (int cell = 0; cell < walls.width * walls.height; ++cell) {
+        if (rand_num() >= threshold)
+            continue;
+        int dirs[4], n = 0;
+        for (int dir = 0; dir < 4; ++dir)
+            if (walls.wall(cell, dir) && walls.neighbour(cell, dir) >= 0)
+                dirs[n++] = dir;
+        if (n > 0)
+            walls.carve(cell, dirs[rand_num.bounded(n)]);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    options_t options;
+    int mismatches = 0;
+
+    if (!parse_options(argc, argv, &options)) {
+        usage();
+        return 1;
+    }
+    printf("%d mazes of %s per preset, %d queries each, braid %.2f\n", options.count, options.generator->name,
+           options.queries, options.braid);
+    printf("%-8s %-14s %14s %12s %12s\n", "preset", "solver", "expanded/query", "steps/query", "us/query");
+
+    int presets = ARRAY_SIZE(difficulty_list);
+    for (int p = 0; p < presets; ++p) {
+        int width = difficulty_list[p].x, height = difficulty_list[p].y;
+        /* some presets only differ in their window */
+        bool seen = false;
+        for (int q = 0; q < p; ++q)
+            seen = seen || (difficulty_list[q].x == width && difficulty_list[q].y == height);
+        if (seen)
+            continue;
+
+        /* the solvers of solver_list, then the junction graph */
+        vector<result_t> results(solver_count + 1, result_t{0, 0, 0});
+        vector<int> path;
+        junction_graph_t graph;
+        double build_seconds = 0;
+        long long nodes = 0;
+        maze_t maze(width, height);
+        maze.generator = options.generator;
+        maze.keep_field = false;
+        for (int i = 0; i < options.count; ++i) {
+            uint64_t seed = options.seed + (uint64_t) i;
+            maze.refresh(seed);
+            rng_t rand_num(seed);
+            braid_maze(maze.mazemap, options.braid, rand_num);
+            chrono::steady_clock::time_point built = chrono::steady_clock::now();
+            graph.build(maze.mazemap);
+            build_seconds += chrono::duration<double>(chrono::steady_clock::now() - built).count();
+            nodes += graph.node_count();
+
+            int maze_size = width * height;
+            for (int q = 0; q < options.queries; ++q) {
+                int from = q == 0 ? (height - 1) * width : (int) rand_num.bounded(maze_size);
+                int to = q == 0 ? width - 1 : (int) rand_num.bounded(maze_size);
+                long long shortest = -1;
+                for (int s = 0; s <= solver_count; ++s) {
+                    long long expanded = 0;
+                    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+                    int found;
+                    if (s < solver_count) {
+                        found = solver_list[s].solve(maze.mazemap, from, to, path, &expanded);
+                    } else {
+                        found = graph.solve(from, to, path);
+                        expanded = graph.expanded;
+                    }
+                    chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+                    long long steps = found ? (long long) path.size() / 2 : -1;
+
+                    results[s].expanded += expanded;
+                    results[s].steps += steps;
+                    results[s].seconds += elapsed.count();
+                    if (s < solver_count && strcmp(solver_list[s].name, "dfs") == 0)
+                        continue;
+                    if (shortest < 0)
+                        shortest = steps;
+                    else if (steps != shortest)
+                        ++mismatches;
+                }
+            }
+        }
+
+        double queries = (double) options.count * options.queries;
+        for (int s = 0; s <= solver_count; ++s) {
+            char preset[16];
+            snprintf(preset, sizeof(preset), "%dx%d", width, height);
+            printf("%-8s %-14s %14.1f %12.1f %12.2f\n", s == 0 ? preset : "",
+                   s < solver_count ? solver_list[s].name : "junction", results[s].expanded / queries,
+                   results[s].steps / queries, results[s].seconds * 1e6 / queries);
+        }
+        printf("%-8s %-14s %d cells, %.1f nodes, built in %.2f us\n", "", "", width * height,
+               (double) nodes / options.count, build_seconds * 1e6 / options.count);
+    }
+    if (mismatches > 0)
+        printf("%d queries where the solvers disagree\n", mismatches);
+    return mismatches > 0;
+}
@@ -0,0 +1,147 @@
+#include <cassert>
+#include <cstring>
+
+#include "wallmap.h"
+
+/* go          up,          down,       left,       right */
+const int offr[4] = {   1,          -1,      0,         0};
+const int offc[4] = {   0,           0,     -1,         1};
+
+/* wall storage */
+
+wallmap_t::wallmap_t() : width(0), height(0), words_per_row(0), words(NULL), word_count(0) {}
+
+wallmap_t::wallmap_t(int width, int height) : width(0), height(0), words_per_row(0), words(NULL), word_count(0) {
+    resize(width, height);
+}
+
+wallmap_t::wallmap_t(const wallmap_t &other) : width(0), height(0), words_per_row(0), words(NULL), word_count(0) {
+    *this = other;
+}
+
+wallmap_t &wallmap_t::operator=(const wallmap_t &other) {
+    if (this != &other) {
+        width = other.width;
+        height = other.height;
+        words_per_row = other.words_per_row;
+        word_count = other.word_count;
+        storage.assign(other.words, other.words + other.word_count);
+        words = storage.data();
+        mapping.reset();
+    }
+    return *this;
+}
+
+void wallmap_t::resize(int width, int height) {
+    assert(width > 0 && height > 0);
+    this->width = width;
+    this->height = height;
+    this->words_per_row = (width + 63) / 64;
+    word_count = (size_t) height * 2 * words_per_row;
+    storage.assign(word_count, 0);
+    words = storage.data();
+    mapping.reset();
+}
+
+void wallmap_t::attach(int width, int height, uint64_t *words, std::shared_ptr<void> mapping) {
+    assert(width > 0 && height > 0 && words != NULL);
+    this->width = width;
+    this->height = height;
+    this->words_per_row = (width + 63) / 64;
+    this->word_count = (size_t) height * 2 * words_per_row;
+    this->words = words;
+    this->mapping = mapping;
+    std::vector<uint64_t>().swap(storage);
+}
+
+void wallmap_t::fill(bool wall) {
+    memset(words, wall ? 0xff : 0, word_count * sizeof(uint64_t));
+}
+
+bool wallmap_t::operator[](int idx) const {
+    int rmw = width * 2 + 1;
+    int x = idx % rmw;
+    int y = idx / rmw;
+    /* outer border */
+    if (x == 0 || y == 0 || x == rmw - 1 || y == height * 2)
+        return true;
+    /* pillars and cell interiors */
+    if ((x & 1) == (y & 1))
+        return !(x & 1);
+    /* wall between two cells */
+    if (x & 1)
+        return wallmap_bit(up_row(y / 2 - 1), x / 2);
+    return wallmap_bit(right_row(y / 2), x / 2 - 1);
+}
+
+void wallmap_t::set(int idx, bool wall) {
+    int rmw = width * 2 + 1;
+    int x = idx % rmw;
+    int y = idx / rmw;
+    if (x == 0 || y == 0 || x == rmw - 1 || y == height * 2 || (x & 1) == (y & 1)) {
+        /* fixed cells can not be changed */
+        assert(wall == (*this)[idx]);
+        return;
+    }
+    uint64_t *row = (x & 1) ? up_row(y / 2 - 1) : right_row(y / 2);
+    int bit = (x & 1) ? x / 2 : x / 2 - 1;
+    if (wall)
+        wallmap_set_bit(row, bit);
+    else
+        wallmap_clear_bit(row, bit);
+}
+
+bool wallmap_t::wall(int cell, int dir) const {
+    int x = cell % width;
+    int y = cell / width;
+    switch (dir) {
+        case DIR_UP:
+            return y == height - 1 || wallmap_bit(up_row(y), x);
+        case DIR_DOWN:
+            return y == 0 || wallmap_bit(up_row(y - 1), x);
+        case DIR_LEFT:
+            return x == 0 || wallmap_bit(right_row(y), x - 1);
+        default:
+            return x == width - 1 || wallmap_bit(right_row(y), x);
+    }
+}
+
+void wallmap_t::carve(int cell, int dir) {
+    int x = cell % width;
+    int y = cell / width;
+    switch (dir) {
+        case DIR_UP:
+            assert(y < height - 1);
+            wallmap_clear_bit(up_row(y), x);
+            break;
+        case DIR_DOWN:
+            assert(y > 0);
+            wallmap_clear_bit(up_row(y - 1), x);
+            break;
+        case DIR_LEFT:
+            assert(x > 0);
+            wallmap_clear_bit(right_row(y), x - 1);
+            break;
+        default:
+            assert(x < width - 1);
+            wallmap_clear_bit(right_row(y), x);
+            break;
+    }
+}
+
+int wallmap_t::neighbour(int cell, int dir) const {
+    int x = cell % width + offc[dir];
+    int y = cell / width + offr[dir];
+    if (x < 0 || y < 0 || x >= width || y >= height)
+        return -1;
+    return y * width + x;
+}
+
+void wallmap_t::store_row(int y, const uint64_t *right, const uint64_t *up) {
+    memcpy(right_row(y), right, words_per_row * sizeof(uint64_t));
+    memcpy(up_row(y), up, words_per_row * sizeof(uint64_t));
+}
+
+size_t wallmap_t::bytes() const {
+    return word_count * sizeof(uint64_t);
+}
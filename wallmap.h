@@ -0,0 +1,84 @@
+#ifndef WALLMAP_H
+#define WALLMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+/* directions, in the order of offr/offc */
+enum {DIR_UP, DIR_DOWN, DIR_LEFT, DIR_RIGHT};
+
+extern const int offr[4];     //offset of row     or y
+extern const int offc[4];     //offset of column  or x
+
+/* bit-packed wall storage
+ *
+ * only the two variable walls of every cell are kept: the one to its right
+ * (x + 1) and the one above it (y + 1). pillars, cell interiors and the outer
+ * border never change, so operator[] derives them and still answers in the
+ * (2w+1)x(2h+1) layout of the old bool mazemap: "1" for walls, "0" for ground.
+ *
+ * bits are stored row by row, each row holding words_per_row words of right
+ * walls followed by words_per_row words of up walls, bit x of a word being
+ * cell x of the row.
+ *
+ * the words are either owned or borrowed from a mapped maze file, see
+ * attach(); copies always own theirs.
+ */
+class wallmap_t {
+public:
+    wallmap_t();
+    wallmap_t(int width, int height);
+    wallmap_t(const wallmap_t &other);
+    wallmap_t &operator=(const wallmap_t &other);
+
+    void resize(int width, int height);
+    void attach(int width, int height, uint64_t *words, std::shared_ptr<void> mapping);
+    void fill(bool wall);
+
+    /* expanded (2w+1)x(2h+1) view */
+    bool operator[](int idx) const;
+    void set(int idx, bool wall);
+
+    /* cell view, dir is one of DIR_* */
+    bool wall(int cell, int dir) const;
+    void carve(int cell, int dir);
+    int neighbour(int cell, int dir) const;     //-1 if it is outside the maze
+
+    /* copies a whole row, in the layout of maze_row_t */
+    void store_row(int y, const uint64_t *right, const uint64_t *up);
+
+    size_t bytes() const;
+    const uint64_t *data() const { return words; }
+
+    /* raw rows, words_per_row words each */
+    uint64_t *right_row(int y) { return words + (size_t) y * 2 * words_per_row; }
+    uint64_t *up_row(int y) { return words + ((size_t) y * 2 + 1) * words_per_row; }
+    const uint64_t *right_row(int y) const { return words + (size_t) y * 2 * words_per_row; }
+    const uint64_t *up_row(int y) const { return words + ((size_t) y * 2 + 1) * words_per_row; }
+
+    int width;
+    int height;
+    int words_per_row;
+
+private:
+    uint64_t *words;
+    size_t word_count;
+    std::vector<uint64_t> storage;
+    std::shared_ptr<void> mapping;
+};
+
+inline bool wallmap_bit(const uint64_t *row, int x) {
+    return (row[x >> 6] >> (x & 63)) & 1;
+}
+
+inline void wallmap_clear_bit(uint64_t *row, int x) {
+    row[x >> 6] &= ~((uint64_t) 1 << (x & 63));
+}
+
+inline void wallmap_set_bit(uint64_t *row, int x) {
+    row[x >> 6] |= (uint64_t) 1 << (x & 63);
+}
+
+#endif
@@ -0,0 +1,190 @@
+#include <cassert>
+#include <cstring>
+
+#include <algorithm>
+
+#include "wave.h"
+
+using namespace std;
+
+static int popcount64(uint64_t x) {
+    x = x - ((x >> 1) & 0x5555555555555555ull);
+    x = (x & 0x3333333333333333ull) + ((x >> 2) & 0x3333333333333333ull);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return (int) ((x * 0x0101010101010101ull) >> 56);
+}
+
+wave_solver_t::wave_solver_t() : expanded(0) {}
+
+/* the cells of word k of row y that the frontier reaches in one step */
+static inline uint64_t step_word(const wallmap_t &walls, const uint64_t *frontier, int y, int k) {
+    int words_per_row = walls.words_per_row;
+    const uint64_t *right = walls.right_row(y);
+    const uint64_t *row = frontier + (size_t) y * words_per_row;
+
+    /* east: open right walls, shifted one cell up the row */
+    uint64_t bits = (row[k] & ~right[k]) << 1;
+    if (k > 0)
+        bits |= (row[k - 1] & ~right[k - 1]) >> 63;
+    /* west: the cell on the right, through the right wall of the new cell */
+    uint64_t west = row[k] >> 1;
+    if (k + 1 < words_per_row)
+        west |= row[k + 1] << 63;
+    bits |= west & ~right[k];
+    /* north and south */
+    if (y > 0)
+        bits |= row[k - words_per_row] & ~walls.up_row(y - 1)[k];
+    if (y < walls.height - 1)
+        bits |= row[k + words_per_row] & ~walls.up_row(y)[k];
+    return bits;
+}
+
+/* moves the frontier into word k of row y, returns true if that reached new cells */
+inline bool wave_solver_t::reach(const wallmap_t &walls, int y, int k, int word, uint64_t last_mask) {
+    uint64_t bits = step_word(walls, frontier.data(), y, k) & ~visited[word];
+    if (k == walls.words_per_row - 1)
+        bits &= last_mask;
+    if (bits == 0)
+        return false;
+    next[word] = bits;
+    visited[word] |= bits;
+    expanded += popcount64(bits);
+    next_active.push_back(word);
+    return true;
+}
+
+/* returns the level of to, -1 if the search runs dry first.
+ *
+ * only the words next to a word of the frontier can change. a thin frontier,
+ * such as the few cells of a corridor, looks at those alone, so a level
+ * costs O(frontier words) however far apart they are; a wide one sweeps
+ * every word of its rows in order */
+int wave_solver_t::search(const wallmap_t &walls, int from, int to, bool keep) {
+    int width = walls.width, height = walls.height, words_per_row = walls.words_per_row;
+    size_t word_count = (size_t) height * words_per_row;
+    uint64_t last_mask = width % 64 ? ((uint64_t) 1 << (width % 64)) - 1 : ~(uint64_t) 0;
+
+    frontier.assign(word_count, 0);
+    next.assign(word_count, 0);
+    visited.assign(word_count, 0);
+    looked.assign(word_count, 0);
+    active.clear();
+    snapshot_bits.clear();
+    snapshot_words.clear();
+    levels.clear();
+
+    int from_word = from / width * words_per_row + from % width / 64;
+    frontier[from_word] = visited[from_word] = (uint64_t) 1 << (from % width % 64);
+    active.push_back(from_word);
+    expanded = 1;
+    if (keep) {
+        levels.push_back(0);
+        snapshot_bits.push_back(frontier[from_word]);
+        snapshot_words.push_back(from_word);
+    }
+    if (from == to)
+        return 0;
+
+    int to_word = to / width * words_per_row + to % width / 64;
+    uint64_t to_bit = (uint64_t) 1 << (to % width % 64);
+    int lo = from / width, hi = lo;     //rows of the frontier
+    for (int level = 1;; ++level) {
+        int y0 = max(lo - 1, 0), y1 = min(hi + 1, height - 1);
+        next_active.clear();
+        if (active.size() * 5 >= (size_t) (y1 - y0 + 1) * words_per_row) {
+            /* a wide frontier: sweep its rows */
+            lo = height;
+            hi = -1;
+            for (int y = y0; y <= y1; ++y) {
+                for (int k = 0, word = y * words_per_row; k < words_per_row; ++k, ++word) {
+                    if (reach(walls, y, k, word, last_mask)) {
+                        lo = min(lo, y);
+                        hi = y;
+                    }
+                }
+            }
+        } else {
+            /* a thin one: the words around it, each once */
+            candidates.clear();
+            for (int word : active) {
+                int y = word / words_per_row, k = word % words_per_row;
+                int around[5] = {word, k > 0 ? word - 1 : -1, k + 1 < words_per_row ? word + 1 : -1,
+                                 y > 0 ? word - words_per_row : -1, y < height - 1 ? word + words_per_row : -1};
+                for (int candidate : around) {
+                    if (candidate >= 0 && looked[candidate] != level) {
+                        looked[candidate] = level;
+                        candidates.push_back(candidate);
+                    }
+                }
+            }
+            lo = height;
+            hi = -1;
+            for (int word : candidates) {
+                int y = word / words_per_row;
+                if (reach(walls, y, word - y * words_per_row, word, last_mask)) {
+                    lo = min(lo, y);
+                    hi = max(hi, y);
+                }
+            }
+        }
+        for (int word : active)
+            frontier[word] = 0;
+        frontier.swap(next);
+        active.swap(next_active);
+        if (active.empty())
+            return -1;
+        if (keep) {
+            sort(active.begin(), active.end());
+            levels.push_back(snapshot_bits.size());
+            for (int word : active) {
+                snapshot_bits.push_back(frontier[word]);
+                snapshot_words.push_back(word);
+            }
+        }
+        if (frontier[to_word] & to_bit)
+            return level;
+    }
+}
+
+bool wave_solver_t::in_level(int level, int cell, int words_per_row, int width) const {
+    int word = cell / width * words_per_row + cell % width / 64;
+    vector<int>::const_iterator first = snapshot_words.begin() + levels[level];
+    vector<int>::const_iterator last = level + 1 < (int) levels.size() ? snapshot_words.begin() + levels[level + 1]
+                                                                       : snapshot_words.end();
+    vector<int>::const_iterator it = lower_bound(first, last, word);
+    if (it == last || *it != word)
+        return false;
+    return (snapshot_bits[it - snapshot_words.begin()] >> (cell % width % 64)) & 1;
+}
+
+int wave_solver_t::distance(const wallmap_t &walls, int from, int to) {
+    return search(walls, from, to, false);
+}
+
+int wave_solver_t::solve(const wallmap_t &walls, int from, int to, vector<int> &path) {
+    path.clear();
+    int level = search(walls, from, to, true);
+    if (level < 0)
+        return 0;
+
+    /* from the goal, step to any neighbour reached one level earlier */
+    int rmw = walls.width * 2 + 1;
+    int cell = to;
+    path.reserve(level * 2 + 1);
+    path.push_back((cell / walls.width * 2 + 1) * rmw + cell % walls.width * 2 + 1);
+    while (level-- > 0) {
+        int dir = 0;
+        for (; dir < 4; ++dir) {
+            if (walls.wall(cell, dir))
+                continue;
+            if (in_level(level, walls.neighbour(cell, dir), walls.words_per_row, walls.width))
+                break;
+        }
+        assert(dir < 4);
+        cell = walls.neighbour(cell, dir);
+        path.push_back(path.back() + offr[dir] * rmw + offc[dir]);
+        path.push_back(path.back() + offr[dir] * rmw + offc[dir]);
+    }
+    reverse(path.begin(), path.end());
+    return 1;
+}
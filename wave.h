@@ -0,0 +1,56 @@
+#ifndef WAVE_H
+#define WAVE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "wallmap.h"
+
+/* bit-parallel breadth-first search
+ *
+ * the frontier is kept as rows of bits in the layout of wallmap_t, so one
+ * level of the search is a few shifts and masks per word around the
+ * frontier: up to 64 cells advance per instruction instead of one.
+ *
+ * the path is recovered backwards from the goal through one snapshot of the
+ * frontier per level; snapshots keep only the words that have bits, so all
+ * of them together hold at most one word per visited cell.
+ *
+ * rows are plain 64-bit words, not AVX2 lanes, on purpose: the frontier of a
+ * maze has one or two cells per word, so wider lanes would mostly carry
+ * zeros. the win is in skipping per-cell work on branchy mazes (prim,
+ * braided); long single corridors (backtracker) are slower than bfs.
+ */
+class wave_solver_t {
+public:
+    wave_solver_t();
+
+    /* steps from cell from to cell to, -1 if there is no path; keeps no snapshots */
+    int distance(const wallmap_t &walls, int from, int to);
+
+    /* fills path with the positions from cell from to cell to like solver_t,
+     * returns 0 if there is no path */
+    int solve(const wallmap_t &walls, int from, int to, std::vector<int> &path);
+
+    long long expanded;                 //cells reached by the last search
+
+private:
+    int search(const wallmap_t &walls, int from, int to, bool keep);
+    bool reach(const wallmap_t &walls, int y, int k, int word, uint64_t last_mask);
+    bool in_level(int level, int cell, int words_per_row, int width) const;
+
+    std::vector<uint64_t> frontier;
+    std::vector<uint64_t> next;
+    std::vector<uint64_t> visited;
+    std::vector<int> looked;            //the last level that looked at every word
+    std::vector<int> active;            //the words of the frontier
+    std::vector<int> next_active;
+    std::vector<int> candidates;
+
+    std::vector<uint64_t> snapshot_bits;
+    std::vector<int> snapshot_words;    //index of every word in snapshot_bits, increasing per level
+    std::vector<size_t> levels;         //first snapshot word of every level
+};
+
+#endif
@@ -113,6 +113,17 @@ static LRESULT CALLBACK process_message(HWND hWnd, UINT uMsg,
 		handle_scroll_message(window, offset);
 		return 0;
 	}
+	else if (uMsg == WM_PAINT) {
+		/* frames only present what changed, so uncovered parts of the
+		 * window come from the surface, which holds the whole last frame */
+		PAINTSTRUCT paint;
+		HDC window_dc = BeginPaint(hWnd, &paint);
+		RECT rect = paint.rcPaint;
+		BitBlt(window_dc, rect.left, rect.top, rect.right - rect.left, rect.bottom - rect.top,
+			window->memory_dc, rect.left, rect.top, SRCCOPY);
+		EndPaint(hWnd, &paint);
+		return 0;
+	}
 	else {
 		return DefWindowProc(hWnd, uMsg, wParam, lParam);
 	}
@@ -255,6 +266,7 @@ void *window_get_userdata(window_t *window) {
 
 void private_blit_image_bgr(image_t *src, image_t *dst);
 void private_blit_buffer_bgr(framebuffer_t *src, image_t *dst);
+void private_blit_buffer_bgr_rect(framebuffer_t *src, image_t *dst, ivec4_t range);
 
 static void present_surface(window_t *window) {
 	HDC window_dc = GetDC(window->handle);
@@ -271,9 +283,21 @@ void window_draw_image(window_t *window, image_t *image) {
 	present_surface(window);
 }
 
+/* converts and shows only the dirty rectangles of buffer; the surface keeps
+ * the rest from the frames before */
 void window_draw_buffer(window_t *window, framebuffer_t *buffer) {
-	private_blit_buffer_bgr(buffer, window->surface);
-	present_surface(window);
+	HDC window_dc = GetDC(window->handle);
+	HDC memory_dc = window->memory_dc;
+	int i;
+	for (i = 0; i < buffer->dirty_count; i++) {
+		ivec4_t range = buffer->dirty[i];
+		int top = buffer->height - 1 - range.w;
+		private_blit_buffer_bgr_rect(buffer, window->surface, range);
+		BitBlt(window_dc, range.x, top, range.y - range.x + 1, range.w - range.z + 1,
+			memory_dc, range.x, top, SRCCOPY);
+	}
+	ReleaseDC(window->handle, window_dc);
+	framebuffer_clear_dirty(buffer);
 }
 
 /* input related functions */